@@ -1,16 +1,27 @@
 #! /bin/bash
 
+# offline tools
+if [[ "$1" == "dirsnap" ]]; then
+    echo ">>> Building dirsnap tool..."
+    mkdir -p ./build/dirsnap
+    g++ -std=c++17 -O2 -I"./tools/dirsnap/include/" -o "./build/dirsnap/dirsnap" ./tools/dirsnap/src/dirsnap.cpp
+    exit $?
+elif [[ "$1" == "dirsnap-test" ]]; then
+    ./tools/dirsnap/test.sh
+    exit $?
+fi
+
 # contract
 if [[ "$1" == "directory" ]]; then
     contract=directory
 else
-    echo "need contract"
+    echo "need contract or tool"
     exit 0
 fi
 
 echo ">>> Building $contract contract..."
 
-# eosio.cdt v1.6.1
+# eosio.cdt v1.8.1
 # -contract=<string>       - Contract name
 # -o=<string>              - Write output to <file>
 # -abigen                  - Generate ABI
@@ -9,6 +9,9 @@
 #include <eosio/action.hpp>
 #include <eosio/singleton.hpp>
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+
+#include <algorithm>
 
 using namespace std;
 using namespace eosio;
@@ -24,6 +27,16 @@ CONTRACT directory : public contract {
     //constants
     const name ADMIN_NAME = name("tlsdirectory");
     const symbol TLOS_SYM = symbol("TLOS", 4);
+    static constexpr name TLOS_CONTRACT = "eosio.token"_n;
+    const uint32_t NONCE_WINDOW_SEC = 86400; //1 day
+    const uint16_t NONCE_PRUNE_BATCH = 2;
+    const uint32_t MAX_DEPOSIT_NONCES = 10; //outstanding contract paid nonces per account
+    const uint16_t MAX_PAGE_SIZE = 100;
+    const uint32_t MAX_REFUND_WINDOW_SEC = 2592000; //30 days
+    const uint32_t FEATURED_ROTATION_SEC = 3600; //1 hour
+    static constexpr uint64_t BUILTIN_CATEGORIES[] = {
+        "games"_n.value, "finance"_n.value, "music"_n.value, "developer"_n.value
+    };
 
     //dapp statuses: submitted, approved, rejected
 
@@ -31,7 +44,16 @@ CONTRACT directory : public contract {
 
     //fees: submitdapp = 50 TLOS
 
-    //categories: games, finance, music, developer, 
+    //tokens: eosio.token TLOS (always accepted), plus admin added tokens
+
+    //categories: games, finance, music, developer, plus admin added categories
+
+    //notify modes: item, queue
+
+    //defined with contract tables and return types
+    struct dapp_setting;
+    struct sale;
+    struct storefront;
 
     //======================== admin actions ========================
 
@@ -59,6 +81,31 @@ CONTRACT directory : public contract {
     //remove dapp from featured list
     ACTION rmvfeatured(uint16_t slot_number);
 
+    //add a weighted entry to a featured slot rotation schedule
+    ACTION addschedule(uint16_t slot_number, name dapp_account, uint32_t weight,
+        time_point_sec start_time, time_point_sec end_time);
+
+    //remove a featured schedule entry
+    ACTION rmvschedule(uint64_t entry_id);
+
+    //erase up to max_prune ended schedule entries
+    ACTION prunesched(uint16_t max_prune);
+
+    //add a category
+    ACTION addcategory(name category_name);
+
+    //remove an empty category
+    ACTION rmvcategory(name category_name);
+
+    //rebuild category dapp counts, walking up to max_rows dapps per call
+    ACTION recountcats(uint16_t max_rows);
+
+    //add a token to the accepted token list
+    ACTION addtoken(name token_contract, symbol token_symbol);
+
+    //remove a token from the accepted token list
+    ACTION rmvtoken(name token_contract, symbol token_symbol);
+
     //pay cpu and net cost for contract trx
     ACTION payforbw();
 
@@ -89,37 +136,134 @@ CONTRACT directory : public contract {
 
     //======================== vending actions ========================
 
-    //add new vending item
-    ACTION regitem(string title, string subtitle, name dapp_account, name item_name, asset price, uint32_t stock);
+    //add new vending item, priced in TLOS unless price_contract is given
+    ACTION regitem(string title, string subtitle, name dapp_account, name item_name, asset price, uint32_t stock,
+        binary_extension<name> price_contract);
 
     //make payment for item and notify contract account to vend item
-    ACTION purchase(name purchaser, name item_name, name dapp_account);
+    ACTION purchase(name purchaser, name item_name, name dapp_account, binary_extension<uint64_t> nonce);
 
     //restock item
     ACTION restock(name item_name, name dapp_account, uint32_t new_stock);
 
+    //make payment for several items with a single contract account notification
+    ACTION checkout(name purchaser, name dapp_account, vector<name> item_names, optional<uint64_t> nonce);
+
     //remove an item
     ACTION rmvitem(name item_name, name dapp_account);
 
+    //set dapp purchase notify mode: item, queue
+    ACTION setnotify(name dapp_account, name notify_mode);
+
+    //drain up to max_sales queued sales in one batch
+    ACTION claimsales(name dapp_account, uint16_t max_sales);
+
+    //notifies contract account of claimed sales
+    ACTION logsales(name dapp_account, vector<sale> sales);
+
+    //set dapp escrow refund window, 0 disables escrow
+    ACTION setescrow(name dapp_account, uint32_t refund_window);
+
+    //fold up to max_settle released escrows into dapp balance
+    ACTION settle(name dapp_account, uint16_t max_settle);
+
+    //refund an escrowed purchase within its refund window, dapp manager only
+    ACTION refund(name dapp_account, uint64_t escrow_id, string memo);
+
+    //======================== query actions ========================
+
+    //returns dapp header, in stock items page, and featured slots in one response
+    //known_version is only meaningful for the same lower_bound, limit, and include_details
+    [[eosio::action]] storefront getstore(name dapp_account, name lower_bound, uint16_t limit,
+        uint64_t known_version, bool include_details);
+
+    //returns the dapp shown in a featured slot now
+    [[eosio::action]] name getfeatured(uint16_t slot_number);
+
     //======================== account actions ========================
 
-    //withdraw TLOS from directory account
-    ACTION withdraw(name account_owner, asset quantity);
+    //withdraw tokens from directory account, TLOS unless token_contract is given
+    ACTION withdraw(name account_owner, asset quantity, binary_extension<name> token_contract);
+
+    //move a legacy TLOS account balance into the balances table ahead of first use
+    ACTION migrateacct(name account_owner);
+
+    //grant a dapp a capped, expiring allowance to purchase on purchaser's behalf
+    ACTION setallowance(name purchaser, name dapp_account, extended_asset max_spend, time_point_sec expiration);
+
+    //revoke a dapp spending allowance
+    ACTION rmvallowance(name purchaser, name dapp_account);
+
+    //erase up to max_sweep expired allowances
+    ACTION sweepallows(uint16_t max_sweep);
 
     //========== notification methods ==========
 
-    //catches TLOS transfers from eosio.token
-    [[eosio::on_notify("eosio.token::transfer")]]
-    void catch_tlos_transfer(name from, name to, asset quantity, string memo);
+    //catches transfers from accepted token contracts
+    [[eosio::on_notify("*::transfer")]]
+    void catch_transfer(name from, name to, asset quantity, string memo);
 
     //========== utility methods ==========
 
     //requires a charge to an account
-    void require_fee(name account_owner, asset quantity);
+    void require_fee(name account_owner, extended_asset quantity);
+
+    //requires a charge to a spender allowance
+    void require_allowance(name account_owner, name spender, extended_asset quantity);
+
+    //requires an unused client nonce, pruning expired nonces
+    void require_nonce(name account_owner, uint64_t nonce, name ram_payer);
+
+    //charges purchaser for an item and credits dapp account or escrow, ram_payer pays for queued records
+    void sell_item(name purchaser, name item_name, name dapp_account, bool spend_allowance, name ram_payer,
+        dapp_setting& settings);
+
+    //returns dapp settings, or defaults if none set
+    dapp_setting get_settings(name dapp_account);
+
+    //saves dapp setting id counters advanced by sell_item
+    void save_counters(const dapp_setting& settings);
+
+    //credits an account, emplacing it if not found
+    void add_balance(name account_owner, extended_asset quantity);
+
+    //validates an accepted token
+    bool valid_token(extended_symbol token_sym);
+
+    //moves a legacy TLOS account into the balances table, returns false if none
+    bool migrate_account(name account_owner);
+
+    //parses an unsigned integer string
+    uint64_t parse_uint(string str);
+
+    //returns the dapp shown in a featured slot at a time, picked by weight from the schedule
+    //falls back to the fixed featured slot if no schedule entry is active
+    name featured_at(uint64_t slot_number, time_point_sec now);
+
+    //mixes a 64 bit value into a well distributed hash (splitmix64)
+    static constexpr uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
 
     //validates a category
     bool valid_category(name category_name);
 
+    //returns true if category is built in, checked without table reads
+    static constexpr bool builtin_category(name category_name) {
+        for (uint64_t c : BUILTIN_CATEGORIES) {
+            if (c == category_name.value) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //increments or decrements a category approved dapp count
+    void update_category_count(name category_name, name dapp_account, bool increment);
+
     //validates a dapp platform
     bool valid_platform(name platform_name);
 
@@ -132,8 +276,9 @@ CONTRACT directory : public contract {
         string version; //v0.2.0
         name admin;
         map<name, asset> fees; //fee_name => fee_amount
+        binary_extension<uint64_t> next_entry_id; //monotonic schedule entry id, absent until first schedule
 
-        EOSLIB_SERIALIZE(config, (version)(admin)(fees))
+        EOSLIB_SERIALIZE(config, (version)(admin)(fees)(next_entry_id))
     };
     typedef singleton<name("config"), config> config_singleton;
 
@@ -157,21 +302,79 @@ CONTRACT directory : public contract {
         map<name, string> platforms; //platform_name => download_link
 
         time_point_sec last_updated;
+        binary_extension<uint64_t> revision; //storefront revision, absent on dapps never touched since
 
         uint64_t primary_key() const { return dapp_account.value; }
         uint64_t by_manager() const { return manager.value; }
         uint64_t by_category() const { return category.value; }
+
+        //updates last_updated and bumps storefront revision
+        void touch(time_point_sec now) {
+            last_updated = now;
+            revision.emplace(revision.has_value() ? revision.value() + 1 : 1);
+        }
+
         EOSLIB_SERIALIZE(dapp, 
             (dapp_account)(manager)(category)(status)
             (icon_small)(icon_large)(title)(subtitle)(description)(website)(version)(slides)(platforms)
-            (last_updated))
+            (last_updated)(revision))
     };
     typedef multi_index<name("dapps"), dapp,
         indexed_by<name("bymanager"), const_mem_fun<dapp, uint64_t, &dapp::by_manager>>,
         indexed_by<name("bycategory"), const_mem_fun<dapp, uint64_t, &dapp::by_category>>
     > dapps_table;
 
-    //account balance
+    //dapp category
+    //scope: self
+    //ram: ~130B
+    TABLE dapp_category {
+        name category_name;
+        uint64_t dapp_count; //approved dapps only
+
+        uint64_t primary_key() const { return category_name.value; }
+        EOSLIB_SERIALIZE(dapp_category, (category_name)(dapp_count))
+    };
+    typedef multi_index<name("categories"), dapp_category> categories_table;
+
+    //category recount progress
+    //scope: singleton
+    //ram: ~120B
+    TABLE recount_state {
+        name cursor; //next dapp_account to walk, dapps before it are counted
+
+        EOSLIB_SERIALIZE(recount_state, (cursor))
+    };
+    typedef singleton<name("recount"), recount_state> recount_singleton;
+
+    //accepted token
+    //scope: token_contract.value
+    //ram: ~130B
+    TABLE token {
+        extended_symbol token_sym;
+
+        uint64_t primary_key() const { return token_sym.get_symbol().raw(); }
+        EOSLIB_SERIALIZE(token, (token_sym))
+    };
+    typedef multi_index<name("tokens"), token> tokens_table;
+
+    //token balance
+    //scope: owner.value
+    //ram: ~150B
+    TABLE token_balance {
+        uint64_t balance_id;
+        extended_asset balance;
+
+        uint64_t primary_key() const { return balance_id; }
+        uint128_t by_ext_symbol() const {
+            return (uint128_t(balance.contract.value) << 64) | balance.quantity.symbol.raw();
+        }
+        EOSLIB_SERIALIZE(token_balance, (balance_id)(balance))
+    };
+    typedef multi_index<name("balances"), token_balance,
+        indexed_by<name("byextsymbol"), const_mem_fun<token_balance, uint128_t, &token_balance::by_ext_symbol>>
+    > balances_table;
+
+    //legacy TLOS account balance, moved to balances on first use
     //scope: owner.value
     //ram: ~300B
     TABLE account {
@@ -182,6 +385,100 @@ CONTRACT directory : public contract {
     };
     typedef multi_index<name("accounts"), account> accounts_table;
 
+    //spending allowance
+    //scope: self
+    //ram: ~150B
+    TABLE allowance {
+        uint64_t allowance_id;
+        name owner;
+        name spender;
+        extended_asset remaining;
+        time_point_sec expiration;
+
+        uint64_t primary_key() const { return allowance_id; }
+        uint128_t by_owner_spender() const { return (uint128_t(owner.value) << 64) | spender.value; }
+        uint64_t by_expiration() const { return static_cast<uint64_t>(expiration.utc_seconds); }
+        EOSLIB_SERIALIZE(allowance, (allowance_id)(owner)(spender)(remaining)(expiration))
+    };
+    typedef multi_index<name("allowances"), allowance,
+        indexed_by<name("byownerspndr"), const_mem_fun<allowance, uint128_t, &allowance::by_owner_spender>>,
+        indexed_by<name("byexpiration"), const_mem_fun<allowance, uint64_t, &allowance::by_expiration>>
+    > allowances_table;
+
+    //client nonce
+    //scope: account_owner.value
+    //ram: ~130B
+    TABLE client_nonce {
+        uint64_t nonce;
+        time_point_sec expiration;
+        name ram_payer;
+
+        uint64_t primary_key() const { return nonce; }
+        uint64_t by_expiration() const { return static_cast<uint64_t>(expiration.utc_seconds); }
+        EOSLIB_SERIALIZE(client_nonce, (nonce)(expiration)(ram_payer))
+    };
+    typedef multi_index<name("nonces"), client_nonce,
+        indexed_by<name("byexpiration"), const_mem_fun<client_nonce, uint64_t, &client_nonce::by_expiration>>
+    > nonces_table;
+
+    //outstanding contract paid nonces
+    //scope: account_owner.value
+    //ram: ~120B
+    TABLE nonce_quota {
+        uint32_t contract_paid;
+
+        EOSLIB_SERIALIZE(nonce_quota, (contract_paid))
+    };
+    typedef singleton<name("noncequota"), nonce_quota> nonce_quota_singleton;
+
+    //dapp settings
+    //scope: self
+    //ram: ~130B
+    TABLE dapp_setting {
+        name dapp_account;
+        name notify_mode; //item, queue
+        uint32_t refund_window; //seconds, 0 = escrow disabled
+        uint64_t next_sale_id; //monotonic, survives drained sales queue
+        uint64_t next_escrow_id; //monotonic, survives settled escrows
+
+        uint64_t primary_key() const { return dapp_account.value; }
+        EOSLIB_SERIALIZE(dapp_setting, (dapp_account)(notify_mode)(refund_window)(next_sale_id)(next_escrow_id))
+    };
+    typedef multi_index<name("settings"), dapp_setting> settings_table;
+
+    //queued sale awaiting claim by dapp
+    //scope: dapp_account.value
+    //ram: ~160B
+    TABLE sale {
+        uint64_t sale_id;
+        name purchaser;
+        name item_name;
+        extended_asset price;
+        time_point_sec purchased_at;
+
+        uint64_t primary_key() const { return sale_id; }
+        EOSLIB_SERIALIZE(sale, (sale_id)(purchaser)(item_name)(price)(purchased_at))
+    };
+    typedef multi_index<name("sales"), sale> sales_table;
+
+    //escrowed sale credit awaiting settlement
+    //scope: dapp_account.value
+    //ram: ~160B
+    TABLE escrow {
+        uint64_t escrow_id;
+        name purchaser;
+        name item_name;
+        extended_asset amount;
+        time_point_sec release_time;
+
+        uint64_t primary_key() const { return escrow_id; }
+        uint64_t by_release() const { return static_cast<uint64_t>(release_time.utc_seconds); }
+        EOSLIB_SERIALIZE(escrow, (escrow_id)(purchaser)(item_name)(amount)(release_time))
+    };
+    typedef multi_index<name("escrows"), escrow,
+        indexed_by<name("byrelease"), const_mem_fun<escrow, uint64_t, &escrow::by_release>>
+    > escrows_table;
+
     //prebuilt in-dapp item payment
     //scope: dapp_account.value
     //ram: 
@@ -191,9 +488,13 @@ CONTRACT directory : public contract {
         string subtitle;
         asset price;
         uint32_t stock;
+        binary_extension<name> price_contract; //absent on items registered before multi-token support
 
         uint64_t primary_key() const { return item_name.value; }
-        EOSLIB_SERIALIZE(item, (item_name)(title)(subtitle)(price)(stock))
+        extended_asset get_price() const {
+            return extended_asset(price, price_contract.has_value() ? price_contract.value() : TLOS_CONTRACT);
+        }
+        EOSLIB_SERIALIZE(item, (item_name)(title)(subtitle)(price)(stock)(price_contract))
     };
     typedef multi_index<name("items"), item> items_table;
 
@@ -209,4 +510,75 @@ CONTRACT directory : public contract {
     };
     typedef multi_index<"featured"_n, featured_slot> featured_table;
 
+    //featured slot rotation entry
+    //scope: self
+    //ram: ~200B
+    TABLE schedule_entry {
+        uint64_t entry_id;
+        uint64_t slot_number;
+        name dapp_account;
+        uint32_t weight;
+        time_point_sec start_time;
+        time_point_sec end_time;
+
+        uint64_t primary_key() const { return entry_id; }
+        uint64_t by_slot() const { return slot_number; }
+        uint64_t by_dapp() const { return dapp_account.value; }
+        uint64_t by_end() const { return static_cast<uint64_t>(end_time.utc_seconds); }
+        EOSLIB_SERIALIZE(schedule_entry, (entry_id)(slot_number)(dapp_account)(weight)(start_time)(end_time))
+    };
+    typedef multi_index<name("schedule"), schedule_entry,
+        indexed_by<name("byslot"), const_mem_fun<schedule_entry, uint64_t, &schedule_entry::by_slot>>,
+        indexed_by<name("bydapp"), const_mem_fun<schedule_entry, uint64_t, &schedule_entry::by_dapp>>,
+        indexed_by<name("byend"), const_mem_fun<schedule_entry, uint64_t, &schedule_entry::by_end>>
+    > schedule_table;
+
+    //======================== return types ========================
+
+    //storefront dapp header
+    struct store_header {
+        name dapp_account;
+        name manager;
+        name category;
+        name status;
+
+        string icon_small;
+        string icon_large;
+        string title;
+        string subtitle;
+        string website;
+        string version;
+
+        optional<string> description; //include_details only
+        optional<vector<string>> slides; //include_details only
+        optional<map<name, string>> platforms; //include_details only
+
+        EOSLIB_SERIALIZE(store_header,
+            (dapp_account)(manager)(category)(status)
+            (icon_small)(icon_large)(title)(subtitle)(website)(version)
+            (description)(slides)(platforms))
+    };
+
+    //storefront item, stock count omitted so version only changes when items go in or out of stock
+    struct store_item {
+        name item_name;
+        string title;
+        string subtitle;
+        extended_asset price;
+
+        EOSLIB_SERIALIZE(store_item, (item_name)(title)(subtitle)(price))
+    };
+
+    //storefront page bundle
+    struct storefront {
+        uint64_t version; //hash of dapp revision and page request parameters
+        bool unchanged; //true if version matches known_version, header and items omitted
+        optional<store_header> header;
+        vector<store_item> items; //in stock items only
+        name next_item; //lower bound of next page, empty if no more items to scan
+        vector<uint64_t> featured_slots;
+
+        EOSLIB_SERIALIZE(storefront, (version)(unchanged)(header)(items)(next_item)(featured_slots))
+    };
+
 };
\ No newline at end of file
@@ -124,9 +124,20 @@ ACTION directory::reviewdapp(name dapp_account, bool approve, string memo) {
         new_status = "rejected"_n;
     }
 
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+
+    //update category count on approval changes
+    if (d.status != "approved"_n && new_status == "approved"_n) {
+        update_category_count(d.category, dapp_account, true);
+    } else if (d.status == "approved"_n && new_status != "approved"_n) {
+        update_category_count(d.category, dapp_account, false);
+    }
+
     //update dapp status
     dapps.modify(d, same_payer, [&](auto& col) {
         col.status = new_status;
+        col.touch(now);
     });
 
 }
@@ -180,6 +191,255 @@ ACTION directory::rmvfeatured(uint16_t slot_number) {
 
 }
 
+ACTION directory::addcategory(name category_name) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open categories table, search for category
+    categories_table categories(get_self(), get_self().value);
+    auto c = categories.find(category_name.value);
+
+    //validate
+    check(!builtin_category(category_name), "category is built in");
+    check(c == categories.end(), "category already exists");
+
+    //emplace category
+    categories.emplace(get_self(), [&](auto& col) {
+        col.category_name = category_name;
+        col.dapp_count = 0;
+    });
+
+}
+
+ACTION directory::rmvcategory(name category_name) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open categories table, get category
+    categories_table categories(get_self(), get_self().value);
+    auto& c = categories.get(category_name.value, "category not found");
+
+    //open dapps table, sort by category
+    dapps_table dapps(get_self(), get_self().value);
+    auto dapps_by_category = dapps.get_index<name("bycategory")>();
+
+    //validate, counts only cover approved dapps
+    check(!builtin_category(category_name), "cannot remove built in category");
+    check(dapps_by_category.find(category_name.value) == dapps_by_category.end(), "category still has dapps");
+
+    //erase category
+    categories.erase(c);
+
+}
+
+ACTION directory::addtoken(name token_contract, symbol token_symbol) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open tokens table, search for token
+    tokens_table tokens(get_self(), token_contract.value);
+    auto t = tokens.find(token_symbol.raw());
+
+    //validate
+    check(is_account(token_contract), "token contract account doesn't exist");
+    check(token_symbol.is_valid(), "invalid token symbol");
+    check(extended_symbol(token_symbol, token_contract) != extended_symbol(TLOS_SYM, TLOS_CONTRACT), "TLOS is always accepted");
+    check(t == tokens.end(), "token already accepted");
+
+    //emplace token
+    tokens.emplace(get_self(), [&](auto& col) {
+        col.token_sym = extended_symbol(token_symbol, token_contract);
+    });
+
+}
+
+ACTION directory::rmvtoken(name token_contract, symbol token_symbol) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open tokens table, get token
+    tokens_table tokens(get_self(), token_contract.value);
+    auto& t = tokens.get(token_symbol.raw(), "token not found");
+
+    //erase token
+    tokens.erase(t);
+
+}
+
+ACTION directory::addschedule(uint16_t slot_number, name dapp_account, uint32_t weight,
+    time_point_sec start_time, time_point_sec end_time) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
+
+    //validate
+    check(weight > 0, "weight must be greater than 0");
+    check(end_time > start_time, "end time must be after start time");
+    check(end_time > time_point_sec(current_time_point()), "end time must be in the future");
+
+    //open schedule table
+    schedule_table schedule(get_self(), get_self().value);
+
+    //initialize, ids are never reused after entries are removed
+    uint64_t entry_id = max(conf.next_entry_id.has_value() ? conf.next_entry_id.value() : 0,
+        schedule.available_primary_key());
+
+    //emplace entry
+    schedule.emplace(get_self(), [&](auto& col) {
+        col.entry_id = entry_id;
+        col.slot_number = slot_number;
+        col.dapp_account = dapp_account;
+        col.weight = weight;
+        col.start_time = start_time;
+        col.end_time = end_time;
+    });
+
+    //advance schedule entry id
+    conf.next_entry_id.emplace(entry_id + 1);
+
+    //set config
+    configs.set(conf, get_self());
+
+}
+
+ACTION directory::rmvschedule(uint64_t entry_id) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //open schedule table, get entry
+    schedule_table schedule(get_self(), get_self().value);
+    auto& e = schedule.get(entry_id, "schedule entry not found");
+
+    //erase entry
+    schedule.erase(e);
+
+}
+
+ACTION directory::prunesched(uint16_t max_prune) {
+
+    //validate
+    check(max_prune > 0, "must prune at least 1 entry");
+
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+    uint16_t pruned = 0;
+
+    //open schedule table, sort by end time
+    schedule_table schedule(get_self(), get_self().value);
+    auto schedule_by_end = schedule.get_index<name("byend")>();
+    auto e = schedule_by_end.begin();
+
+    //erase ended entries, oldest first
+    while (e != schedule_by_end.end() && e->end_time <= now && pruned < max_prune) {
+        e = schedule_by_end.erase(e);
+        pruned++;
+    }
+
+    check(pruned > 0, "no ended schedule entries to prune");
+
+}
+
+ACTION directory::recountcats(uint16_t max_rows) {
+
+    //open config singleton, get config
+    config_singleton configs(get_self(), get_self().value);
+    auto conf = configs.get();
+
+    //authenticate
+    require_auth(conf.admin);
+
+    //validate
+    check(max_rows > 0, "must walk at least 1 dapp");
+
+    //open categories table and recount singleton
+    categories_table categories(get_self(), get_self().value);
+    recount_singleton recount(get_self(), get_self().value);
+
+    //start recount, zeroing all counts
+    if (!recount.exists()) {
+        for (auto c = categories.begin(); c != categories.end(); c++) {
+            categories.modify(c, same_payer, [&](auto& col) {
+                col.dapp_count = 0;
+            });
+        }
+        recount.set(recount_state{name()}, get_self());
+    }
+
+    //initialize
+    recount_state state = recount.get();
+    map<name, uint64_t> approved; //category_name => approved dapps in batch
+    uint16_t walked = 0;
+
+    //open dapps table, walk from cursor
+    dapps_table dapps(get_self(), get_self().value);
+    auto d = dapps.lower_bound(state.cursor.value);
+
+    while (d != dapps.end() && walked < max_rows) {
+        if (d->status == "approved"_n) {
+            approved[d->category] += 1;
+        }
+        d++;
+        walked++;
+    }
+
+    //add batch counts, one write per category
+    for (auto& a : approved) {
+        auto c = categories.find(a.first.value);
+
+        if (c == categories.end()) { //built in category without count
+            categories.emplace(get_self(), [&](auto& col) {
+                col.category_name = a.first;
+                col.dapp_count = a.second;
+            });
+        } else {
+            categories.modify(c, same_payer, [&](auto& col) {
+                col.dapp_count += a.second;
+            });
+        }
+    }
+
+    //finish recount, or save cursor for next batch
+    if (d == dapps.end()) {
+        recount.remove();
+    } else {
+        recount.set(recount_state{d->dapp_account}, get_self());
+    }
+
+}
+
 ACTION directory::payforbw() {
 
     //authenticate
@@ -200,7 +460,7 @@ ACTION directory::submitdapp(string title, string subtitle, string description,
     auto conf = configs.get();
 
     //charge fee
-    require_fee(dapp_account, conf.fees.at("submitdapp"_n));
+    require_fee(dapp_account, extended_asset(conf.fees.at("submitdapp"_n), TLOS_CONTRACT));
 
     //initialize
     vector<string> blank_slides;
@@ -291,6 +551,7 @@ ACTION directory::updateinfo(name dapp_account, optional<string> new_title, opti
         col.description = description;
         col.website = website;
         col.version = version;
+        col.touch(now);
     });
 
 }
@@ -325,7 +586,7 @@ ACTION directory::updateicons(name dapp_account, optional<string> new_icon_small
     dapps.modify(d, same_payer, [&](auto& col) {
         col.icon_small = icon_small;
         col.icon_large = icon_large;
-        col.last_updated = now;
+        col.touch(now);
     });
 
 }
@@ -348,7 +609,7 @@ ACTION directory::updateslides(name dapp_account, vector<string> new_slides) {
     //update dapp slides
     dapps.modify(d, same_payer, [&](auto& col) {
         col.slides = new_slides;
-        col.last_updated = now;
+        col.touch(now);
     });
 
 }
@@ -377,7 +638,7 @@ ACTION directory::setplatforms(name dapp_account, map<name, string> new_platform
     //update dapp platforms
     dapps.modify(d, same_payer, [&](auto& col) {
         col.platforms = new_platforms;
-        col.last_updated = now;
+        col.touch(now);
     });
 
 }
@@ -400,7 +661,7 @@ ACTION directory::chmanager(name dapp_account, name new_manager, string memo) {
     //update dapp manager
     dapps.modify(d, same_payer, [&](auto& col) {
         col.manager = new_manager;
-        col.last_updated = now;
+        col.touch(now);
     });
 
 }
@@ -423,6 +684,11 @@ ACTION directory::deletedapp(name dapp_account, string memo) {
         require_auth(d.manager);
     }
 
+    //update category count
+    if (d.status == "approved"_n) {
+        update_category_count(d.category, dapp_account, false);
+    }
+
     //erase dapp entry
     dapps.erase(d);
 
@@ -430,7 +696,8 @@ ACTION directory::deletedapp(name dapp_account, string memo) {
 
 //======================== purchasable actions ========================
 
-ACTION directory::regitem(string title, string subtitle, name dapp_account, name item_name, asset price, uint32_t stock) {
+ACTION directory::regitem(string title, string subtitle, name dapp_account, name item_name, asset price, uint32_t stock,
+    binary_extension<name> price_contract) {
 
     //open dapps table, get dapp
     dapps_table dapps(get_self(), get_self().value);
@@ -443,9 +710,12 @@ ACTION directory::regitem(string title, string subtitle, name dapp_account, name
     //authenticate
     require_auth(d.manager);
 
+    //initialize
+    name token_contract = price_contract.has_value() ? price_contract.value() : TLOS_CONTRACT;
+
     //validate
     check(i == items.end(), "tem already exists");
-    check(price.symbol == TLOS_SYM, "price must be denominated in TLOS");
+    check(valid_token(extended_symbol(price.symbol, token_contract)), "price must be denominated in an accepted token");
     check(price.amount > 0, "price amount must be greater than 0");
     check(stock > 0, "stock must be a positive number");
 
@@ -454,7 +724,7 @@ ACTION directory::regitem(string title, string subtitle, name dapp_account, name
     auto conf = configs.get();
 
     //charge fee
-    require_fee(d.manager, conf.fees.at("regitem"_n));
+    require_fee(d.manager, extended_asset(conf.fees.at("regitem"_n), TLOS_CONTRACT));
 
     //emplace new dapp item
     items.emplace(d.manager, [&](auto& col) {
@@ -463,45 +733,76 @@ ACTION directory::regitem(string title, string subtitle, name dapp_account, name
         col.subtitle = subtitle;
         col.price = price;
         col.stock = stock;
+        col.price_contract.emplace(token_contract);
+    });
+
+    //update dapp storefront version
+    dapps.modify(d, same_payer, [&](auto& col) {
+        col.touch(time_point_sec(current_time_point()));
     });
 
 }
 
-ACTION directory::purchase(name purchaser, name item_name, name dapp_account) {
+ACTION directory::purchase(name purchaser, name item_name, name dapp_account, binary_extension<uint64_t> nonce) {
 
-    //authenticate
-    require_auth(purchaser);
+    //authenticate purchaser, or dapp spending from a purchaser allowance
+    bool spend_allowance = !has_auth(purchaser);
 
-    //open dapps table, get dapp
-    dapps_table dapps(get_self(), get_self().value);
-    auto& d = dapps.get(dapp_account.value, "dapp not found");
+    if (spend_allowance) {
+        require_auth(dapp_account);
+    }
 
-    //open items table, get item
-    items_table items(get_self(), dapp_account.value);
-    auto& i = items.get(item_name.value, "item not found");
+    //initialize, ram paid by authorizer
+    name ram_payer = spend_allowance ? dapp_account : purchaser;
+    dapp_setting settings = get_settings(dapp_account);
 
-    //charge price to purchaser account
-    require_fee(purchaser, i.price);
+    //reject replayed purchase
+    if (nonce.has_value()) {
+        require_nonce(purchaser, nonce.value(), ram_payer);
+    }
+
+    //sell item
+    sell_item(purchaser, item_name, dapp_account, spend_allowance, ram_payer, settings);
+    save_counters(settings);
+
+    //notify contract account of purchase
+    if (settings.notify_mode == "item"_n) {
+        require_recipient(dapp_account);
+    }
+
+}
+
+ACTION directory::checkout(name purchaser, name dapp_account, vector<name> item_names, optional<uint64_t> nonce) {
 
-    //open accounts table, get account
-    accounts_table accounts(get_self(), dapp_account.value);
-    auto& a = accounts.get(TLOS_SYM.code().raw(), "account not found");
+    //authenticate purchaser, or dapp spending from a purchaser allowance
+    bool spend_allowance = !has_auth(purchaser);
+
+    if (spend_allowance) {
+        require_auth(dapp_account);
+    }
 
     //validate
-    check(i.stock > 0, "stock is empty");
+    check(item_names.size() > 0, "must checkout at least 1 item");
 
-    //decrement item stock
-    items.modify(i, same_payer, [&](auto& col) {
-        col.stock -= 1;
-    });
+    //initialize, ram paid by authorizer
+    name ram_payer = spend_allowance ? dapp_account : purchaser;
+    dapp_setting settings = get_settings(dapp_account);
 
-    //deposit item price to dapp account
-    accounts.modify(a, same_payer, [&](auto& col) {
-        col.balance += i.price;
-    });
+    //reject replayed checkout
+    if (nonce) {
+        require_nonce(purchaser, *nonce, ram_payer);
+    }
 
-    //notify contract account of purchase
-    require_recipient(dapp_account);
+    //sell items
+    for (name item_name : item_names) {
+        sell_item(purchaser, item_name, dapp_account, spend_allowance, ram_payer, settings);
+    }
+    save_counters(settings);
+
+    //notify contract account once for entire checkout
+    if (settings.notify_mode == "item"_n) {
+        require_recipient(dapp_account);
+    }
 
 }
 
@@ -523,6 +824,11 @@ ACTION directory::restock(name item_name, name dapp_account, uint32_t new_stock)
         col.stock = new_stock;
     });
 
+    //update dapp storefront version
+    dapps.modify(d, same_payer, [&](auto& col) {
+        col.touch(time_point_sec(current_time_point()));
+    });
+
 }
 
 ACTION directory::rmvitem(name item_name, name dapp_account) {
@@ -541,102 +847,818 @@ ACTION directory::rmvitem(name item_name, name dapp_account) {
     //erase item
     items.erase(i);
 
+    //update dapp storefront version
+    dapps.modify(d, same_payer, [&](auto& col) {
+        col.touch(time_point_sec(current_time_point()));
+    });
+
 }
 
-//======================== account actions ========================
+ACTION directory::setnotify(name dapp_account, name notify_mode) {
 
-ACTION directory::withdraw(name account_owner, asset quantity) {
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
 
     //authenticate
-    require_auth(account_owner);
+    require_auth(d.manager);
 
-    //open accounts table, get account
-    accounts_table accounts(get_self(), account_owner.value);
-    auto& acct = accounts.get(TLOS_SYM.code().raw(), "account not found");
+    //validate
+    check(notify_mode == "item"_n || notify_mode == "queue"_n, "invalid notify mode");
+
+    //open settings table, search for dapp settings
+    settings_table settings(get_self(), get_self().value);
+    auto s = settings.find(dapp_account.value);
+
+    //emplace settings if not found, update if exists
+    if (s == settings.end()) { //no settings
+        settings.emplace(d.manager, [&](auto& col) {
+            col.dapp_account = dapp_account;
+            col.notify_mode = notify_mode;
+            col.refund_window = 0;
+            col.next_sale_id = 0;
+            col.next_escrow_id = 0;
+        });
+    } else { //exists
+        settings.modify(s, same_payer, [&](auto& col) {
+            col.notify_mode = notify_mode;
+        });
+    }
+
+}
+
+ACTION directory::claimsales(name dapp_account, uint16_t max_sales) {
+
+    //authenticate
+    require_auth(dapp_account);
 
     //validate
-    check(acct.balance >= quantity, "insufficient balance");
-    check(quantity.amount > 0, "must withdraw a positive amount");
+    check(max_sales > 0, "must claim at least 1 sale");
 
-    //charge withdrawal amount to account owner
-    accounts.modify(acct, same_payer, [&](auto& col) {
-        col.balance -= quantity;
-    });
+    //initialize
+    vector<sale> claimed;
 
-    //send inline to eosio.token
-    action(permission_level{get_self(), name("active")}, name("eosio.token"), name("transfer"), make_tuple(
-		get_self(), //from
-		account_owner, //to
-		quantity, //quantity
-        std::string("dapp store withdrawal") //memo
-	)).send();
+    //open sales table, drain oldest sales
+    sales_table sales(get_self(), dapp_account.value);
+    auto s = sales.begin();
 
-}
+    while (s != sales.end() && claimed.size() < max_sales) {
+        claimed.push_back(*s);
+        s = sales.erase(s);
+    }
 
-//========== notification methods ==========
+    check(claimed.size() > 0, "no pending sales to claim");
 
-void directory::catch_tlos_transfer(name from, name to, asset quantity, string memo) {
+    //send inline logsales to notify dapp of claimed batch
+    action(permission_level{get_self(), name("active")}, get_self(), name("logsales"), make_tuple(
+        dapp_account, //dapp_account
+        claimed //sales
+    )).send();
 
-    //get initial receiver contract
-    name rec = get_first_receiver();
+}
 
-    //validate
-    if (rec == name("eosio.token") && from != get_self() && quantity.symbol == TLOS_SYM) {
-        
-        //parse memo
-        if (memo == std::string("skip")) {
-            return;
-        } else {
+ACTION directory::logsales(name dapp_account, vector<sale> sales) {
+
+    //authenticate
+    require_auth(get_self());
+
+    //notify contract account of claimed sales
+    require_recipient(dapp_account);
 
-            //open accounts table, search for account
-            accounts_table accounts(get_self(), from.value);
-            auto acct = accounts.find(TLOS_SYM.code().raw());
-
-            //emplace account if not found, update if exists
-            if (acct == accounts.end()) { //no account
-                accounts.emplace(get_self(), [&](auto& col) {
-                    col.balance = quantity;
-                });
-            } else { //exists
-                accounts.modify(*acct, same_payer, [&](auto& col) {
-                    col.balance += quantity;
-                });
-            }
-        }
-    }
 }
 
-//========== utility methods ==========
+ACTION directory::setescrow(name dapp_account, uint32_t refund_window) {
 
-void directory::require_fee(name account_owner, asset quantity) {
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
 
-    //open accounts table, get account
-    accounts_table accounts(get_self(), account_owner.value);
-    auto& acct = accounts.get(quantity.symbol.code().raw(), "require_fee: account not found");
+    //authenticate
+    require_auth(d.manager);
 
     //validate
-    check(acct.balance >= quantity, "require_fee: insufficient funds");
-
-    //update account balance
-    accounts.modify(acct, same_payer, [&](auto& col) {
-        col.balance -= quantity;
-    });
+    check(refund_window <= MAX_REFUND_WINDOW_SEC, "refund window cannot exceed 30 days");
+
+    //open settings table, search for dapp settings
+    settings_table settings(get_self(), get_self().value);
+    auto s = settings.find(dapp_account.value);
+
+    //emplace settings if not found, update if exists
+    if (s == settings.end()) { //no settings
+        settings.emplace(d.manager, [&](auto& col) {
+            col.dapp_account = dapp_account;
+            col.notify_mode = "item"_n;
+            col.refund_window = refund_window;
+            col.next_sale_id = 0;
+            col.next_escrow_id = 0;
+        });
+    } else { //exists
+        settings.modify(s, same_payer, [&](auto& col) {
+            col.refund_window = refund_window;
+        });
+    }
 
 }
 
-bool directory::valid_category(name category_name) {
+ACTION directory::settle(name dapp_account, uint16_t max_settle) {
 
-    switch (category_name.value) {
-        case (name("games").value):
-            return true;
-        case (name("finance").value):
-            return true;
-        case (name("music").value):
-            return true;
-        case (name("developer").value):
-            return true;
-        default:
-            return false;
+    //validate
+    check(max_settle > 0, "must settle at least 1 escrow");
+
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+    map<extended_symbol, extended_asset> totals; //token => settled total
+    uint16_t settled = 0;
+
+    //open escrows table, sort by release time
+    escrows_table escrows(get_self(), dapp_account.value);
+    auto escrows_by_release = escrows.get_index<name("byrelease")>();
+    auto e = escrows_by_release.begin();
+
+    //erase released escrows, oldest first
+    while (e != escrows_by_release.end() && e->release_time <= now && settled < max_settle) {
+        auto t = totals.find(e->amount.get_extended_symbol());
+        if (t == totals.end()) {
+            totals.emplace(e->amount.get_extended_symbol(), e->amount);
+        } else {
+            t->second += e->amount;
+        }
+        e = escrows_by_release.erase(e);
+        settled++;
+    }
+
+    check(settled > 0, "no released escrows to settle");
+
+    //deposit settled totals to dapp account in one write per token
+    for (auto& t : totals) {
+        add_balance(dapp_account, t.second);
+    }
+
+}
+
+ACTION directory::refund(name dapp_account, uint64_t escrow_id, string memo) {
+
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
+
+    //authenticate
+    require_auth(d.manager);
+
+    //open escrows table, get escrow
+    escrows_table escrows(get_self(), dapp_account.value);
+    auto& e = escrows.get(escrow_id, "escrow not found");
+
+    //validate
+    check(e.release_time > time_point_sec(current_time_point()), "refund window has closed");
+
+    //return escrowed amount to purchaser account
+    add_balance(e.purchaser, e.amount);
+
+    //erase escrow
+    escrows.erase(e);
+
+}
+
+//======================== query actions ========================
+
+directory::storefront directory::getstore(name dapp_account, name lower_bound, uint16_t limit,
+    uint64_t known_version, bool include_details) {
+
+    //validate
+    check(limit > 0 && limit <= MAX_PAGE_SIZE, "limit must be between 1 and 100");
+
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
+
+    //initialize
+    storefront page;
+    time_point_sec now = time_point_sec(current_time_point());
+
+    //mix dapp revision and page request into version token
+    uint64_t x = d.revision.has_value() ? d.revision.value() : 0;
+    for (uint64_t part : {uint64_t(d.last_updated.utc_seconds), lower_bound.value, uint64_t(limit), uint64_t(include_details)}) {
+        x = splitmix64(x ^ part);
+    }
+    page.version = x;
+    page.unchanged = (page.version == known_version);
+
+    //collect candidate slots from fixed featured slots and dapp schedule entries
+    vector<uint64_t> candidate_slots;
+    featured_table featured(get_self(), get_self().value);
+
+    for (auto f = featured.begin(); f != featured.end(); f++) {
+        if (f->featured_dapp == dapp_account) {
+            candidate_slots.push_back(f->slot_number);
+        }
+    }
+
+    schedule_table schedule(get_self(), get_self().value);
+    auto schedule_by_dapp = schedule.get_index<name("bydapp")>();
+
+    for (auto e = schedule_by_dapp.lower_bound(dapp_account.value);
+        e != schedule_by_dapp.end() && e->dapp_account == dapp_account; e++) {
+        candidate_slots.push_back(e->slot_number);
+    }
+
+    sort(candidate_slots.begin(), candidate_slots.end());
+    candidate_slots.erase(unique(candidate_slots.begin(), candidate_slots.end()), candidate_slots.end());
+
+    //keep slots currently showing dapp
+    for (uint64_t slot_number : candidate_slots) {
+        if (featured_at(slot_number, now) == dapp_account) {
+            page.featured_slots.push_back(slot_number);
+        }
+    }
+
+    //skip header and items if client is up to date
+    if (page.unchanged) {
+        return page;
+    }
+
+    //set dapp header
+    store_header header = {
+        d.dapp_account, //dapp_account
+        d.manager, //manager
+        d.category, //category
+        d.status, //status
+        d.icon_small, //icon_small
+        d.icon_large, //icon_large
+        d.title, //title
+        d.subtitle, //subtitle
+        d.website, //website
+        d.version //version
+    };
+
+    if (include_details) {
+        header.description = d.description;
+        header.slides = d.slides;
+        header.platforms = d.platforms;
+    }
+
+    page.header = header;
+
+    //open items table, scan up to limit items, returning those in stock
+    items_table items(get_self(), dapp_account.value);
+    auto i = items.lower_bound(lower_bound.value);
+    uint16_t scanned = 0;
+
+    while (i != items.end() && scanned < limit) {
+        if (i->stock > 0) {
+            page.items.push_back(store_item{i->item_name, i->title, i->subtitle, i->get_price()});
+        }
+        i++;
+        scanned++;
+    }
+
+    //set next page lower bound where scan stopped
+    if (i != items.end()) {
+        page.next_item = i->item_name;
+    }
+
+    return page;
+
+}
+
+name directory::getfeatured(uint16_t slot_number) {
+
+    return featured_at(slot_number, time_point_sec(current_time_point()));
+
+}
+
+//======================== account actions ========================
+
+ACTION directory::withdraw(name account_owner, asset quantity, binary_extension<name> token_contract) {
+
+    //authenticate
+    require_auth(account_owner);
+
+    //initialize
+    name transfer_contract = token_contract.has_value() ? token_contract.value() : TLOS_CONTRACT;
+
+    //validate
+    check(quantity.amount > 0, "must withdraw a positive amount");
+
+    //charge withdrawal amount to account owner
+    require_fee(account_owner, extended_asset(quantity, transfer_contract));
+
+    //send inline to token contract
+    action(permission_level{get_self(), name("active")}, transfer_contract, name("transfer"), make_tuple(
+		get_self(), //from
+		account_owner, //to
+		quantity, //quantity
+        std::string("dapp store withdrawal") //memo
+	)).send();
+
+}
+
+ACTION directory::migrateacct(name account_owner) {
+
+    //move legacy account
+    check(migrate_account(account_owner), "legacy account not found");
+
+}
+
+ACTION directory::setallowance(name purchaser, name dapp_account, extended_asset max_spend, time_point_sec expiration) {
+
+    //authenticate
+    require_auth(purchaser);
+
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+
+    //validate
+    check(is_account(dapp_account), "dapp account doesn't exist");
+    check(valid_token(max_spend.get_extended_symbol()), "allowance must be denominated in an accepted token");
+    check(max_spend.quantity.amount > 0, "allowance amount must be greater than 0");
+    check(expiration > now, "expiration must be in the future");
+
+    //open allowances table, search for allowance
+    allowances_table allowances(get_self(), get_self().value);
+    auto allowances_by_pair = allowances.get_index<name("byownerspndr")>();
+    auto a = allowances_by_pair.find((uint128_t(purchaser.value) << 64) | dapp_account.value);
+
+    //emplace allowance if not found, update if exists
+    if (a == allowances_by_pair.end()) { //no allowance
+        allowances.emplace(purchaser, [&](auto& col) {
+            col.allowance_id = allowances.available_primary_key();
+            col.owner = purchaser;
+            col.spender = dapp_account;
+            col.remaining = max_spend;
+            col.expiration = expiration;
+        });
+    } else { //exists
+        allowances_by_pair.modify(a, same_payer, [&](auto& col) {
+            col.remaining = max_spend;
+            col.expiration = expiration;
+        });
+    }
+
+}
+
+ACTION directory::rmvallowance(name purchaser, name dapp_account) {
+
+    //authenticate
+    require_auth(purchaser);
+
+    //open allowances table, get allowance
+    allowances_table allowances(get_self(), get_self().value);
+    auto allowances_by_pair = allowances.get_index<name("byownerspndr")>();
+    auto& a = allowances_by_pair.get((uint128_t(purchaser.value) << 64) | dapp_account.value, "allowance not found");
+
+    //erase allowance
+    allowances.erase(a);
+
+}
+
+ACTION directory::sweepallows(uint16_t max_sweep) {
+
+    //validate
+    check(max_sweep > 0, "must sweep at least 1 allowance");
+
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+    uint16_t swept = 0;
+
+    //open allowances table, sort by expiration
+    allowances_table allowances(get_self(), get_self().value);
+    auto allowances_by_exp = allowances.get_index<name("byexpiration")>();
+    auto a = allowances_by_exp.begin();
+
+    //erase expired allowances, oldest first
+    while (a != allowances_by_exp.end() && a->expiration <= now && swept < max_sweep) {
+        a = allowances_by_exp.erase(a);
+        swept++;
+    }
+
+    check(swept > 0, "no expired allowances to sweep");
+
+}
+
+//========== notification methods ==========
+
+void directory::catch_transfer(name from, name to, asset quantity, string memo) {
+
+    //get initial receiver contract
+    name rec = get_first_receiver();
+
+    //validate
+    if (to == get_self() && from != get_self() && valid_token(extended_symbol(quantity.symbol, rec))) {
+        
+        //parse memo
+        if (memo == std::string("skip")) {
+            return;
+        } else {
+
+            //reject replayed deposit, ram paid by contract
+            if (memo.rfind("nonce:", 0) == 0) {
+                require_nonce(from, parse_uint(memo.substr(6)), get_self());
+            }
+
+            //deposit to sender account
+            add_balance(from, extended_asset(quantity, rec));
+        }
+    }
+}
+
+//========== utility methods ==========
+
+void directory::require_fee(name account_owner, extended_asset quantity) {
+
+    //open balances table, search for balance
+    balances_table balances(get_self(), account_owner.value);
+    auto balances_by_sym = balances.get_index<name("byextsymbol")>();
+    uint128_t ext_sym = (uint128_t(quantity.contract.value) << 64) | quantity.quantity.symbol.raw();
+    auto bal = balances_by_sym.find(ext_sym);
+
+    //move legacy TLOS account on first use
+    if (bal == balances_by_sym.end() && quantity.get_extended_symbol() == extended_symbol(TLOS_SYM, TLOS_CONTRACT) &&
+        migrate_account(account_owner)) {
+        bal = balances_by_sym.find(ext_sym);
+    }
+
+    //validate
+    check(bal != balances_by_sym.end(), "require_fee: account not found");
+    check(bal->balance.quantity >= quantity.quantity, "require_fee: insufficient funds");
+
+    //update account balance
+    balances_by_sym.modify(bal, same_payer, [&](auto& col) {
+        col.balance -= quantity;
+    });
+
+}
+
+void directory::require_allowance(name account_owner, name spender, extended_asset quantity) {
+
+    //open allowances table, get allowance
+    allowances_table allowances(get_self(), get_self().value);
+    auto allowances_by_pair = allowances.get_index<name("byownerspndr")>();
+    auto& a = allowances_by_pair.get((uint128_t(account_owner.value) << 64) | spender.value, "require_allowance: allowance not found");
+
+    //validate
+    check(a.expiration > time_point_sec(current_time_point()), "require_allowance: allowance expired");
+    check(a.remaining.get_extended_symbol() == quantity.get_extended_symbol(), "require_allowance: allowance token mismatch");
+    check(a.remaining.quantity >= quantity.quantity, "require_allowance: allowance exceeded");
+
+    //update allowance, erase if spent
+    if (a.remaining == quantity) {
+        allowances.erase(a);
+    } else {
+        allowances.modify(a, same_payer, [&](auto& col) {
+            col.remaining -= quantity;
+        });
+    }
+
+}
+
+void directory::require_nonce(name account_owner, uint64_t nonce, name ram_payer) {
+
+    //initialize
+    time_point_sec now = time_point_sec(current_time_point());
+    uint16_t pruned = 0;
+
+    //open nonce quota singleton, get contract paid count
+    nonce_quota_singleton quota(get_self(), account_owner.value);
+    uint32_t initial_paid = quota.exists() ? quota.get().contract_paid : 0;
+    uint32_t contract_paid = initial_paid;
+
+    //open nonces table, sort by expiration
+    nonces_table nonces(get_self(), account_owner.value);
+    auto nonces_by_exp = nonces.get_index<name("byexpiration")>();
+    auto n = nonces_by_exp.begin();
+
+    //prune a few expired nonces
+    while (n != nonces_by_exp.end() && n->expiration <= now && pruned < NONCE_PRUNE_BATCH) {
+        if (n->ram_payer == get_self()) {
+            contract_paid--;
+        }
+        n = nonces_by_exp.erase(n);
+        pruned++;
+    }
+
+    //search for nonce
+    auto existing = nonces.find(nonce);
+
+    if (existing != nonces.end()) {
+        //validate
+        check(existing->expiration <= now, "require_nonce: nonce already used");
+
+        //erase expired nonce not yet pruned, replaced below
+        if (existing->ram_payer == get_self()) {
+            contract_paid--;
+        }
+        nonces.erase(existing);
+    }
+
+    //limit contract paid nonces
+    if (ram_payer == get_self()) {
+        check(contract_paid < MAX_DEPOSIT_NONCES, "require_nonce: too many outstanding deposit nonces");
+        contract_paid++;
+    }
+
+    //emplace nonce
+    nonces.emplace(ram_payer, [&](auto& col) {
+        col.nonce = nonce;
+        col.expiration = now + NONCE_WINDOW_SEC;
+        col.ram_payer = ram_payer;
+    });
+
+    //update contract paid count
+    if (contract_paid != initial_paid) {
+        if (contract_paid == 0) {
+            quota.remove();
+        } else {
+            quota.set(nonce_quota{contract_paid}, get_self());
+        }
+    }
+
+}
+
+uint64_t directory::parse_uint(string str) {
+
+    //validate
+    check(str.size() > 0 && str.size() <= 20, "parse_uint: invalid number length");
+
+    //initialize
+    uint64_t result = 0;
+
+    for (char c : str) {
+        check(c >= '0' && c <= '9', "parse_uint: invalid digit");
+        uint64_t digit = c - '0';
+        check(result <= (UINT64_MAX - digit) / 10, "parse_uint: number overflow");
+        result = result * 10 + digit;
+    }
+
+    return result;
+
+}
+
+void directory::sell_item(name purchaser, name item_name, name dapp_account, bool spend_allowance, name ram_payer,
+    dapp_setting& settings) {
+
+    //open dapps table, get dapp
+    dapps_table dapps(get_self(), get_self().value);
+    auto& d = dapps.get(dapp_account.value, "dapp not found");
+
+    //open items table, get item
+    items_table items(get_self(), dapp_account.value);
+    auto& i = items.get(item_name.value, "item not found");
+
+    //initialize
+    extended_asset price = i.get_price();
+
+    //charge price to dapp allowance
+    if (spend_allowance) {
+        require_allowance(purchaser, dapp_account, price);
+    }
+
+    //charge price to purchaser account
+    require_fee(purchaser, price);
+
+    //validate
+    check(i.stock > 0, "stock is empty");
+
+    //decrement item stock
+    items.modify(i, same_payer, [&](auto& col) {
+        col.stock -= 1;
+    });
+
+    if (settings.refund_window > 0) {
+        //append item price to dapp escrow, settled later in batches, ram paid by authorizer until settled
+        escrows_table escrows(get_self(), dapp_account.value);
+        escrows.emplace(ram_payer, [&](auto& col) {
+            col.escrow_id = settings.next_escrow_id++;
+            col.purchaser = purchaser;
+            col.item_name = item_name;
+            col.amount = price;
+            col.release_time = time_point_sec(current_time_point()) + settings.refund_window;
+        });
+    } else {
+        //deposit item price to dapp account
+        add_balance(dapp_account, price);
+    }
+
+    //update dapp storefront version if item sold out
+    if (i.stock == 0) {
+        dapps.modify(d, same_payer, [&](auto& col) {
+            col.touch(time_point_sec(current_time_point()));
+        });
+    }
+
+    //append sale to dapp queue, ram paid by authorizer until claimed
+    if (settings.notify_mode == "queue"_n) {
+        sales_table sales(get_self(), dapp_account.value);
+        sales.emplace(ram_payer, [&](auto& col) {
+            col.sale_id = settings.next_sale_id++;
+            col.purchaser = purchaser;
+            col.item_name = item_name;
+            col.price = price;
+            col.purchased_at = time_point_sec(current_time_point());
+        });
+    }
+
+}
+
+directory::dapp_setting directory::get_settings(name dapp_account) {
+
+    //open settings table, search for dapp settings
+    settings_table settings(get_self(), get_self().value);
+    auto s = settings.find(dapp_account.value);
+
+    //default to per item notifications without escrow
+    if (s == settings.end()) {
+        return dapp_setting{dapp_account, "item"_n, 0, 0, 0};
+    }
+
+    return *s;
+
+}
+
+void directory::save_counters(const dapp_setting& settings) {
+
+    //open settings table, search for dapp settings
+    settings_table settings_tbl(get_self(), get_self().value);
+    auto s = settings_tbl.find(settings.dapp_account.value);
+
+    //default settings advance no counters
+    if (s == settings_tbl.end() ||
+        (s->next_sale_id == settings.next_sale_id && s->next_escrow_id == settings.next_escrow_id)) {
+        return;
+    }
+
+    //update counters once per action
+    settings_tbl.modify(s, same_payer, [&](auto& col) {
+        col.next_sale_id = settings.next_sale_id;
+        col.next_escrow_id = settings.next_escrow_id;
+    });
+
+}
+
+void directory::add_balance(name account_owner, extended_asset quantity) {
+
+    //open balances table, search for balance
+    balances_table balances(get_self(), account_owner.value);
+    auto balances_by_sym = balances.get_index<name("byextsymbol")>();
+    uint128_t ext_sym = (uint128_t(quantity.contract.value) << 64) | quantity.quantity.symbol.raw();
+    auto bal = balances_by_sym.find(ext_sym);
+
+    //move legacy TLOS account on first use
+    if (bal == balances_by_sym.end() && quantity.get_extended_symbol() == extended_symbol(TLOS_SYM, TLOS_CONTRACT) &&
+        migrate_account(account_owner)) {
+        bal = balances_by_sym.find(ext_sym);
+    }
+
+    //emplace balance if not found, update if exists
+    if (bal == balances_by_sym.end()) { //no balance
+        balances.emplace(get_self(), [&](auto& col) {
+            col.balance_id = balances.available_primary_key();
+            col.balance = quantity;
+        });
+    } else { //exists
+        balances_by_sym.modify(bal, same_payer, [&](auto& col) {
+            col.balance += quantity;
+        });
+    }
+
+}
+
+bool directory::valid_token(extended_symbol token_sym) {
+
+    //accept TLOS without table read
+    if (token_sym == extended_symbol(TLOS_SYM, TLOS_CONTRACT)) {
+        return true;
+    }
+
+    //open tokens table, search for token
+    tokens_table tokens(get_self(), token_sym.get_contract().value);
+
+    return tokens.find(token_sym.get_symbol().raw()) != tokens.end();
+
+}
+
+name directory::featured_at(uint64_t slot_number, time_point_sec now) {
+
+    //initialize
+    vector<pair<name, uint32_t>> active; //dapp_account => weight
+    uint64_t total_weight = 0;
+
+    //open schedule table, collect active slot entries in entry_id order
+    schedule_table schedule(get_self(), get_self().value);
+    auto schedule_by_slot = schedule.get_index<name("byslot")>();
+
+    for (auto e = schedule_by_slot.lower_bound(slot_number);
+        e != schedule_by_slot.end() && e->slot_number == slot_number; e++) {
+        if (e->start_time <= now && now < e->end_time) {
+            active.emplace_back(e->dapp_account, e->weight);
+            total_weight += e->weight;
+        }
+    }
+
+    //fall back to fixed featured slot
+    if (total_weight == 0) {
+        featured_table featured(get_self(), get_self().value);
+        auto f = featured.find(slot_number);
+
+        if (f != featured.end() && f->featured_until > now) {
+            return f->featured_dapp;
+        }
+
+        return name();
+    }
+
+    //mix rotation period and slot into a deterministic pick
+    uint64_t pick = splitmix64((uint64_t(now.utc_seconds / FEATURED_ROTATION_SEC) << 16) ^ slot_number) % total_weight;
+
+    //walk cumulative weights
+    for (auto& a : active) {
+        if (pick < a.second) {
+            return a.first;
+        }
+        pick -= a.second;
+    }
+
+    return active.back().first;
+
+}
+
+bool directory::migrate_account(name account_owner) {
+
+    //open accounts table, search for legacy account
+    accounts_table accounts(get_self(), account_owner.value);
+    auto acct = accounts.find(TLOS_SYM.code().raw());
+
+    if (acct == accounts.end()) {
+        return false;
+    }
+
+    //open balances table, search for TLOS balance
+    balances_table balances(get_self(), account_owner.value);
+    auto balances_by_sym = balances.get_index<name("byextsymbol")>();
+    auto bal = balances_by_sym.find((uint128_t(TLOS_CONTRACT.value) << 64) | TLOS_SYM.raw());
+
+    //emplace balance if not found, merge if exists
+    if (bal == balances_by_sym.end()) { //no balance
+        balances.emplace(get_self(), [&](auto& col) {
+            col.balance_id = balances.available_primary_key();
+            col.balance = extended_asset(acct->balance, TLOS_CONTRACT);
+        });
+    } else { //exists
+        balances_by_sym.modify(bal, same_payer, [&](auto& col) {
+            col.balance += extended_asset(acct->balance, TLOS_CONTRACT);
+        });
+    }
+
+    //erase legacy account
+    accounts.erase(acct);
+
+    return true;
+
+}
+
+bool directory::valid_category(name category_name) {
+
+    //check built in categories
+    if (builtin_category(category_name)) {
+        return true;
+    }
+
+    //open categories table, search for category
+    categories_table categories(get_self(), get_self().value);
+
+    return categories.find(category_name.value) != categories.end();
+
+}
+
+void directory::update_category_count(name category_name, name dapp_account, bool increment) {
+
+    //skip dapps a running recount has not reached yet, the walk counts their current status
+    recount_singleton recount(get_self(), get_self().value);
+
+    if (recount.exists() && dapp_account.value >= recount.get().cursor.value) {
+        return;
+    }
+
+    //open categories table, search for category
+    categories_table categories(get_self(), get_self().value);
+    auto c = categories.find(category_name.value);
+
+    if (increment) {
+        if (c == categories.end()) { //built in category without count
+            categories.emplace(get_self(), [&](auto& col) {
+                col.category_name = category_name;
+                col.dapp_count = 1;
+            });
+        } else {
+            categories.modify(c, same_payer, [&](auto& col) {
+                col.dapp_count += 1;
+            });
+        }
+    } else if (c != categories.end() && c->dapp_count > 0) {
+        //skip missing or zero counts, left for recountcats to correct
+        categories.modify(c, same_payer, [&](auto& col) {
+            col.dapp_count -= 1;
+        });
     }
 
 }
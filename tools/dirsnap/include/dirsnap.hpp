@@ -0,0 +1,199 @@
+// An offline columnar snapshot builder for directory contract tables.
+//
+// contract: directory
+// version: v0.2.0
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dirsnap {
+
+    using std::map;
+    using std::string;
+    using std::string_view;
+    using std::vector;
+
+    //constants
+    constexpr char MAGIC[8] = {'D', 'I', 'R', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint32_t FORMAT_VERSION = 2;
+
+    //platforms, mirrors directory::valid_platform, bit index = position
+    constexpr const char* PLATFORMS[] = {"ios", "android", "mac", "linux", "windows", "web"};
+
+    //throws if condition is false, mirrors eosio::check
+    inline void check(bool condition, const string& message) {
+        if (!condition) {
+            throw std::runtime_error(message);
+        }
+    }
+
+    //======================== eosio types ========================
+
+    //encodes an eosio name string
+    uint64_t string_to_name(string_view str);
+
+    //decodes an eosio name value
+    string name_to_string(uint64_t value);
+
+    //parses an eosio asset string, e.g. "1.0000 TLOS"
+    void parse_asset(string_view str, int64_t& amount, uint64_t& symbol_raw);
+
+    //parses an eosio time_point_sec string, e.g. "2019-12-03T00:00:00"
+    uint32_t parse_time_point_sec(string_view str);
+
+    //======================== table rows ========================
+
+    //mirrors directory::dapp
+    struct dapp_row {
+        uint64_t dapp_account = 0;
+        uint64_t manager = 0;
+        uint64_t category = 0;
+        uint64_t status = 0;
+
+        string icon_small;
+        string icon_large;
+        string title;
+        string subtitle;
+        string description;
+        string website;
+        string version;
+        uint32_t platforms = 0; //bitmask over PLATFORMS
+
+        uint32_t last_updated = 0;
+    };
+
+    //mirrors directory::item
+    struct item_row {
+        uint64_t item_name = 0;
+        string title;
+        string subtitle;
+        int64_t price_amount = 0;
+        uint64_t price_symbol = 0;
+        uint64_t price_contract = 0; //eosio.token if absent from dump
+        uint32_t stock = 0;
+    };
+
+    //in-memory directory catalog
+    struct catalog {
+        map<uint64_t, dapp_row> dapps; //dapp_account => dapp
+        map<uint64_t, vector<item_row>> items; //dapp_account => items scope
+        vector<uint64_t> deleted; //delta dumps only
+        uint32_t watermark = 0; //max dapp last_updated
+    };
+
+    //reads a JSON table dump:
+    //{ "dapps": <rows>, "items": { "<dapp_account>": <rows>, ... }, "deleted": ["<dapp_account>", ...] }
+    //where <rows> is an array of rows or a get_table_rows response with a "rows" array
+    catalog read_dump(const string& path);
+
+    //applies a delta dump, replacing dapps and item scopes with newer last_updated
+    void apply_delta(catalog& base, const catalog& delta);
+
+    //======================== columnar file ========================
+
+    //fixed width column sections, 8 byte aligned
+    enum section : uint32_t {
+        DAPP_ACCOUNT, //uint64_t[dapp_count]
+        DAPP_MANAGER, //uint64_t[dapp_count]
+        DAPP_CATEGORY, //uint64_t[dapp_count]
+        DAPP_STATUS, //uint64_t[dapp_count]
+        DAPP_LAST_UPDATED, //uint32_t[dapp_count]
+        DAPP_PLATFORMS, //uint32_t[dapp_count]
+        DAPP_ITEM_BEGIN, //uint32_t[dapp_count]
+        DAPP_ITEM_COUNT, //uint32_t[dapp_count]
+        DAPP_ICON_SMALL, //str_ref[dapp_count]
+        DAPP_ICON_LARGE, //str_ref[dapp_count]
+        DAPP_TITLE, //str_ref[dapp_count]
+        DAPP_SUBTITLE, //str_ref[dapp_count]
+        DAPP_DESCRIPTION, //str_ref[dapp_count]
+        DAPP_WEBSITE, //str_ref[dapp_count]
+        DAPP_VERSION, //str_ref[dapp_count]
+        GROUPS, //group[group_count]
+        ITEM_DAPP, //uint32_t[item_count], dapp row index
+        ITEM_NAME, //uint64_t[item_count]
+        ITEM_PRICE_AMOUNT, //int64_t[item_count]
+        ITEM_PRICE_SYMBOL, //uint64_t[item_count]
+        ITEM_PRICE_CONTRACT, //uint64_t[item_count]
+        ITEM_STOCK, //uint32_t[item_count], as of the dapp's last_updated, see README
+        ITEM_TITLE, //str_ref[item_count]
+        ITEM_SUBTITLE, //str_ref[item_count]
+        STRINGS, //char[], string pool
+        SECTION_COUNT
+    };
+
+    //string pool reference
+    struct str_ref {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    //contiguous dapp rows sharing a category and status
+    //dapp rows are sorted by (category, status, dapp_account)
+    struct group {
+        uint64_t category;
+        uint64_t status;
+        uint32_t begin;
+        uint32_t count;
+    };
+
+    //file header
+    struct file_header {
+        char magic[8];
+        uint32_t format_version;
+        uint32_t watermark;
+        uint32_t dapp_count;
+        uint32_t item_count;
+        uint32_t group_count;
+        uint32_t reserved;
+        uint64_t file_size;
+        uint64_t section_offsets[SECTION_COUNT];
+        uint64_t section_sizes[SECTION_COUNT];
+    };
+
+    //writes a catalog as a columnar file, replacing path atomically
+    void write_snapshot(const catalog& cat, const string& path);
+
+    //read-only memory-mapped view of a columnar file
+    class snapshot_view {
+
+        public:
+
+        explicit snapshot_view(const string& path);
+
+        ~snapshot_view();
+
+        snapshot_view(const snapshot_view&) = delete;
+        snapshot_view& operator=(const snapshot_view&) = delete;
+
+        const file_header& header() const { return *hdr; }
+
+        //returns a typed column
+        template<typename T>
+        const T* column(section sec) const {
+            return reinterpret_cast<const T*>(base + hdr->section_offsets[sec]);
+        }
+
+        //returns a pooled string
+        string_view str(str_ref ref) const;
+
+        //returns the dapp row range for a category and status, count is 0 if none
+        group find_group(uint64_t category, uint64_t status) const;
+
+        //rebuilds an in-memory catalog
+        catalog to_catalog() const;
+
+        private:
+
+        const char* base = nullptr;
+        size_t size = 0;
+        const file_header* hdr = nullptr;
+
+    };
+
+}
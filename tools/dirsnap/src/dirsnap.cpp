@@ -0,0 +1,929 @@
+#include "../include/dirsnap.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <tuple>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dirsnap {
+
+//======================== json ========================
+
+namespace {
+
+    //parsed json value, numbers are kept as their source text
+    struct json {
+        enum kind_t { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+        kind_t kind = NUL;
+        bool boolean = false;
+        string text; //number or string
+        vector<json> elements; //array
+        vector<std::pair<string, json>> members; //object
+
+        const json* find(string_view key) const {
+            for (auto& m : members) {
+                if (m.first == key) {
+                    return &m.second;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    class json_parser {
+
+        public:
+
+        explicit json_parser(string_view src) : src(src) {}
+
+        json parse() {
+            json value = parse_value();
+            skip_ws();
+            check(pos == src.size(), "json: trailing characters");
+            return value;
+        }
+
+        private:
+
+        string_view src;
+        size_t pos = 0;
+
+        void skip_ws() {
+            while (pos < src.size() && (src[pos] == ' ' || src[pos] == '\t' || src[pos] == '\n' || src[pos] == '\r')) {
+                pos++;
+            }
+        }
+
+        char peek() {
+            skip_ws();
+            check(pos < src.size(), "json: unexpected end of input");
+            return src[pos];
+        }
+
+        void expect(char c) {
+            check(peek() == c, string("json: expected '") + c + "'");
+            pos++;
+        }
+
+        void expect_word(string_view word) {
+            check(src.substr(pos, word.size()) == word, "json: invalid literal");
+            pos += word.size();
+        }
+
+        json parse_value() {
+            json value;
+            char c = peek();
+
+            if (c == '{') {
+                value.kind = json::OBJECT;
+                pos++;
+                if (peek() == '}') {
+                    pos++;
+                    return value;
+                }
+                while (true) {
+                    check(peek() == '"', "json: expected object key");
+                    string key = parse_string();
+                    expect(':');
+                    value.members.emplace_back(key, parse_value());
+                    if (peek() == ',') {
+                        pos++;
+                        continue;
+                    }
+                    expect('}');
+                    return value;
+                }
+            } else if (c == '[') {
+                value.kind = json::ARRAY;
+                pos++;
+                if (peek() == ']') {
+                    pos++;
+                    return value;
+                }
+                while (true) {
+                    value.elements.push_back(parse_value());
+                    if (peek() == ',') {
+                        pos++;
+                        continue;
+                    }
+                    expect(']');
+                    return value;
+                }
+            } else if (c == '"') {
+                value.kind = json::STRING;
+                value.text = parse_string();
+            } else if (c == 't') {
+                expect_word("true");
+                value.kind = json::BOOL;
+                value.boolean = true;
+            } else if (c == 'f') {
+                expect_word("false");
+                value.kind = json::BOOL;
+            } else if (c == 'n') {
+                expect_word("null");
+            } else {
+                size_t start = pos;
+                while (pos < src.size() && (isdigit(static_cast<unsigned char>(src[pos])) ||
+                    src[pos] == '-' || src[pos] == '+' || src[pos] == '.' || src[pos] == 'e' || src[pos] == 'E')) {
+                    pos++;
+                }
+                check(pos > start, "json: unexpected character");
+                value.kind = json::NUMBER;
+                value.text = string(src.substr(start, pos - start));
+            }
+
+            return value;
+        }
+
+        uint32_t parse_hex4() {
+            check(pos + 4 <= src.size(), "json: truncated unicode escape");
+            uint32_t code = 0;
+            for (int i = 0; i < 4; i++) {
+                char h = src[pos++];
+                code <<= 4;
+                if (h >= '0' && h <= '9') {
+                    code |= h - '0';
+                } else if (h >= 'a' && h <= 'f') {
+                    code |= h - 'a' + 10;
+                } else if (h >= 'A' && h <= 'F') {
+                    code |= h - 'A' + 10;
+                } else {
+                    check(false, "json: invalid unicode escape");
+                }
+            }
+            return code;
+        }
+
+        static void append_utf8(string& out, uint32_t code) {
+            if (code < 0x80) {
+                out += static_cast<char>(code);
+            } else if (code < 0x800) {
+                out += static_cast<char>(0xc0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else if (code < 0x10000) {
+                out += static_cast<char>(0xe0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            } else {
+                out += static_cast<char>(0xf0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                out += static_cast<char>(0x80 | (code & 0x3f));
+            }
+        }
+
+        string parse_string() {
+            expect('"');
+            string out;
+
+            while (true) {
+                check(pos < src.size(), "json: unterminated string");
+                char c = src[pos++];
+
+                if (c == '"') {
+                    return out;
+                } else if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+
+                check(pos < src.size(), "json: unterminated escape");
+                char e = src[pos++];
+
+                switch (e) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        uint32_t code = parse_hex4();
+                        if (code >= 0xd800 && code < 0xdc00) {
+                            check(src.substr(pos, 2) == "\\u", "json: unpaired surrogate");
+                            pos += 2;
+                            uint32_t low = parse_hex4();
+                            check(low >= 0xdc00 && low < 0xe000, "json: invalid surrogate pair");
+                            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        }
+                        append_utf8(out, code);
+                        break;
+                    }
+                    default:
+                        check(false, "json: invalid escape");
+                }
+            }
+        }
+
+    };
+
+    //returns a required object member
+    const json& member(const json& obj, string_view key) {
+        const json* value = obj.find(key);
+        check(value != nullptr, "dump: missing field " + string(key));
+        return *value;
+    }
+
+    //returns a string member, or empty if absent
+    string string_member(const json& obj, string_view key) {
+        const json* value = obj.find(key);
+        if (value == nullptr || value->kind == json::NUL) {
+            return "";
+        }
+        check(value->kind == json::STRING, "dump: field " + string(key) + " is not a string");
+        return value->text;
+    }
+
+    //returns an unsigned integer member, cleos prints large integers as strings
+    uint64_t uint_member(const json& obj, string_view key) {
+        const json& value = member(obj, key);
+        check(value.kind == json::NUMBER || value.kind == json::STRING, "dump: field " + string(key) + " is not a number");
+        check(!value.text.empty() && value.text.find_first_not_of("0123456789") == string::npos,
+            "dump: field " + string(key) + " is not an unsigned integer");
+        return std::stoull(value.text);
+    }
+
+    uint64_t name_member(const json& obj, string_view key) {
+        return string_to_name(string_member(obj, key));
+    }
+
+    //returns rows from an array or a get_table_rows response
+    const vector<json>& table_rows(const json& table) {
+        if (table.kind == json::OBJECT) {
+            const json& rows = member(table, "rows");
+            check(rows.kind == json::ARRAY, "dump: rows is not an array");
+            return rows.elements;
+        }
+        check(table.kind == json::ARRAY, "dump: table is not an array");
+        return table.elements;
+    }
+
+    uint32_t platform_mask(const json& platforms) {
+        uint32_t mask = 0;
+
+        //map<name, string> serializes as [{"key": name, "value": link}]
+        check(platforms.kind == json::ARRAY, "dump: platforms is not an array");
+
+        for (auto& p : platforms.elements) {
+            string platform = p.kind == json::OBJECT ? string_member(p, "key") :
+                (p.kind == json::ARRAY && !p.elements.empty() ? p.elements[0].text : "");
+            for (uint32_t bit = 0; bit < std::size(PLATFORMS); bit++) {
+                if (platform == PLATFORMS[bit]) {
+                    mask |= 1u << bit;
+                }
+            }
+        }
+
+        return mask;
+    }
+
+    dapp_row parse_dapp(const json& row) {
+        dapp_row d;
+        d.dapp_account = name_member(row, "dapp_account");
+        d.manager = name_member(row, "manager");
+        d.category = name_member(row, "category");
+        d.status = name_member(row, "status");
+        d.icon_small = string_member(row, "icon_small");
+        d.icon_large = string_member(row, "icon_large");
+        d.title = string_member(row, "title");
+        d.subtitle = string_member(row, "subtitle");
+        d.description = string_member(row, "description");
+        d.website = string_member(row, "website");
+        d.version = string_member(row, "version");
+        if (const json* platforms = row.find("platforms")) {
+            d.platforms = platform_mask(*platforms);
+        }
+        d.last_updated = parse_time_point_sec(string_member(row, "last_updated"));
+        return d;
+    }
+
+    item_row parse_item(const json& row) {
+        item_row i;
+        i.item_name = name_member(row, "item_name");
+        i.title = string_member(row, "title");
+        i.subtitle = string_member(row, "subtitle");
+        parse_asset(string_member(row, "price"), i.price_amount, i.price_symbol);
+        string price_contract = string_member(row, "price_contract");
+        i.price_contract = string_to_name(price_contract.empty() ? "eosio.token" : price_contract);
+        uint64_t stock = uint_member(row, "stock");
+        check(stock <= UINT32_MAX, "dump: stock out of range");
+        i.stock = static_cast<uint32_t>(stock);
+        return i;
+    }
+
+}
+
+//======================== eosio types ========================
+
+namespace {
+
+    uint64_t name_char_value(char c) {
+        if (c == '.') {
+            return 0;
+        } else if (c >= '1' && c <= '5') {
+            return c - '1' + 1;
+        } else if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 6;
+        }
+        check(false, "name: invalid character");
+        return 0;
+    }
+
+}
+
+uint64_t string_to_name(string_view str) {
+
+    //validate
+    check(str.size() <= 13, "name: string is too long");
+
+    //initialize
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < str.size() && i < 12; i++) {
+        value |= (name_char_value(str[i]) & 0x1f) << (64 - 5 * (i + 1));
+    }
+
+    if (str.size() == 13) {
+        uint64_t last = name_char_value(str[12]);
+        check(last <= 0x0f, "name: invalid thirteenth character");
+        value |= last;
+    }
+
+    return value;
+
+}
+
+string name_to_string(uint64_t value) {
+
+    //initialize
+    static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+    string str(13, '.');
+    uint64_t tmp = value;
+
+    for (uint32_t i = 0; i <= 12; i++) {
+        char c = charmap[tmp & (i == 0 ? 0x0f : 0x1f)];
+        str[12 - i] = c;
+        tmp >>= (i == 0 ? 4 : 5);
+    }
+
+    //trim trailing dots
+    size_t end = str.find_last_not_of('.');
+    return end == string::npos ? "" : str.substr(0, end + 1);
+
+}
+
+void parse_asset(string_view str, int64_t& amount, uint64_t& symbol_raw) {
+
+    //split amount and symbol code
+    size_t space = str.find(' ');
+    check(space != string_view::npos, "asset: missing symbol");
+    string_view number = str.substr(0, space);
+    string_view code = str.substr(space + 1);
+
+    //validate
+    check(!code.empty() && code.size() <= 7, "asset: invalid symbol code");
+
+    //initialize
+    bool negative = !number.empty() && number[0] == '-';
+    if (negative) {
+        number.remove_prefix(1);
+    }
+    size_t dot = number.find('.');
+    uint64_t precision = dot == string_view::npos ? 0 : number.size() - dot - 1;
+    check(precision <= 18, "asset: precision too large");
+    check(!number.empty(), "asset: missing amount");
+
+    int64_t value = 0;
+    for (char c : number) {
+        if (c == '.') {
+            continue;
+        }
+        check(c >= '0' && c <= '9', "asset: invalid amount");
+        check(value <= (INT64_MAX - (c - '0')) / 10, "asset: amount overflow");
+        value = value * 10 + (c - '0');
+    }
+    amount = negative ? -value : value;
+
+    //symbol raw value is precision in the low byte, code characters above
+    symbol_raw = precision;
+    for (size_t i = 0; i < code.size(); i++) {
+        check(code[i] >= 'A' && code[i] <= 'Z', "asset: invalid symbol code");
+        symbol_raw |= static_cast<uint64_t>(code[i]) << (8 * (i + 1));
+    }
+
+}
+
+uint32_t parse_time_point_sec(string_view str) {
+
+    //validate, fractional seconds and trailing zone are ignored
+    check(str.size() >= 19 && str[4] == '-' && str[7] == '-' && str[10] == 'T' && str[13] == ':' && str[16] == ':',
+        "time: expected YYYY-MM-DDTHH:MM:SS");
+
+    auto field = [&](size_t offset, size_t length) {
+        int value = 0;
+        for (size_t i = offset; i < offset + length; i++) {
+            check(str[i] >= '0' && str[i] <= '9', "time: invalid digit");
+            value = value * 10 + (str[i] - '0');
+        }
+        return value;
+    };
+
+    int year = field(0, 4);
+    int month = field(5, 2);
+    int day = field(8, 2);
+    check(year >= 1970 && month >= 1 && month <= 12 && day >= 1 && day <= 31, "time: date out of range");
+
+    //days from civil date
+    int y = month <= 2 ? year - 1 : year;
+    int era = y / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = static_cast<int64_t>(era) * 146097 + doe - 719468;
+
+    int64_t seconds = days * 86400 + field(11, 2) * 3600 + field(14, 2) * 60 + field(17, 2);
+    check(seconds >= 0 && seconds <= UINT32_MAX, "time: out of range");
+
+    return static_cast<uint32_t>(seconds);
+
+}
+
+//======================== table rows ========================
+
+catalog read_dump(const string& path) {
+
+    //read dump file
+    std::ifstream in(path, std::ios::binary);
+    check(in.good(), "dump: cannot open " + path);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    string text = buffer.str();
+
+    //parse
+    json root = json_parser(text).parse();
+    check(root.kind == json::OBJECT, "dump: root is not an object");
+
+    //initialize
+    catalog cat;
+
+    if (const json* dapps = root.find("dapps")) {
+        for (auto& row : table_rows(*dapps)) {
+            dapp_row d = parse_dapp(row);
+            cat.watermark = std::max(cat.watermark, d.last_updated);
+            cat.dapps[d.dapp_account] = std::move(d);
+        }
+    }
+
+    if (const json* items = root.find("items")) {
+        check(items->kind == json::OBJECT, "dump: items is not an object");
+        for (auto& scope : items->members) {
+            vector<item_row>& rows = cat.items[string_to_name(scope.first)];
+            for (auto& row : table_rows(scope.second)) {
+                rows.push_back(parse_item(row));
+            }
+        }
+    }
+
+    if (const json* deleted = root.find("deleted")) {
+        check(deleted->kind == json::ARRAY, "dump: deleted is not an array");
+        for (auto& d : deleted->elements) {
+            check(d.kind == json::STRING, "dump: deleted entry is not a name");
+            cat.deleted.push_back(string_to_name(d.text));
+        }
+    }
+
+    return cat;
+
+}
+
+void apply_delta(catalog& base, const catalog& delta) {
+
+    //erase deleted dapps
+    for (uint64_t dapp_account : delta.deleted) {
+        base.dapps.erase(dapp_account);
+        base.items.erase(dapp_account);
+    }
+
+    //replace changed dapps, item scopes are replaced with their dapp
+    for (auto& [dapp_account, d] : delta.dapps) {
+        auto existing = base.dapps.find(dapp_account);
+
+        if (existing != base.dapps.end() && existing->second.last_updated > d.last_updated) {
+            continue; //stale delta row
+        }
+
+        base.dapps[dapp_account] = d;
+
+        auto items = delta.items.find(dapp_account);
+        if (items != delta.items.end()) {
+            base.items[dapp_account] = items->second;
+        }
+
+        base.watermark = std::max(base.watermark, d.last_updated);
+    }
+
+}
+
+//======================== columnar file ========================
+
+namespace {
+
+    //accumulates column sections and a string pool
+    class snapshot_writer {
+
+        public:
+
+        vector<string> sections = vector<string>(SECTION_COUNT);
+
+        template<typename T>
+        void push(section sec, const T& value) {
+            sections[sec].append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void push_str(section sec, const string& str) {
+            check(sections[STRINGS].size() + str.size() <= UINT32_MAX, "snapshot: string pool too large");
+            str_ref ref = {static_cast<uint32_t>(sections[STRINGS].size()), static_cast<uint32_t>(str.size())};
+            sections[STRINGS] += str;
+            push(sec, ref);
+        }
+
+    };
+
+    uint64_t align8(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+}
+
+void write_snapshot(const catalog& cat, const string& path) {
+
+    //sort dapps by category, status, account
+    vector<const dapp_row*> rows;
+    rows.reserve(cat.dapps.size());
+    for (auto& entry : cat.dapps) {
+        rows.push_back(&entry.second);
+    }
+    std::sort(rows.begin(), rows.end(), [](const dapp_row* a, const dapp_row* b) {
+        return std::tie(a->category, a->status, a->dapp_account) < std::tie(b->category, b->status, b->dapp_account);
+    });
+
+    //initialize
+    snapshot_writer w;
+    vector<group> groups;
+    uint32_t item_count = 0;
+
+    for (uint32_t index = 0; index < rows.size(); index++) {
+        const dapp_row& d = *rows[index];
+
+        //start new group on category or status change
+        if (groups.empty() || d.category != groups.back().category || d.status != groups.back().status) {
+            groups.push_back(group{d.category, d.status, index, 0});
+        }
+        groups.back().count++;
+
+        w.push(DAPP_ACCOUNT, d.dapp_account);
+        w.push(DAPP_MANAGER, d.manager);
+        w.push(DAPP_CATEGORY, d.category);
+        w.push(DAPP_STATUS, d.status);
+        w.push(DAPP_LAST_UPDATED, d.last_updated);
+        w.push(DAPP_PLATFORMS, d.platforms);
+        w.push_str(DAPP_ICON_SMALL, d.icon_small);
+        w.push_str(DAPP_ICON_LARGE, d.icon_large);
+        w.push_str(DAPP_TITLE, d.title);
+        w.push_str(DAPP_SUBTITLE, d.subtitle);
+        w.push_str(DAPP_DESCRIPTION, d.description);
+        w.push_str(DAPP_WEBSITE, d.website);
+        w.push_str(DAPP_VERSION, d.version);
+
+        //append dapp item scope
+        uint32_t item_begin = item_count;
+        auto scope = cat.items.find(d.dapp_account);
+        if (scope != cat.items.end()) {
+            for (auto& i : scope->second) {
+                w.push(ITEM_DAPP, index);
+                w.push(ITEM_NAME, i.item_name);
+                w.push(ITEM_PRICE_AMOUNT, i.price_amount);
+                w.push(ITEM_PRICE_SYMBOL, i.price_symbol);
+                w.push(ITEM_PRICE_CONTRACT, i.price_contract);
+                w.push(ITEM_STOCK, i.stock);
+                w.push_str(ITEM_TITLE, i.title);
+                w.push_str(ITEM_SUBTITLE, i.subtitle);
+                item_count++;
+            }
+        }
+        w.push(DAPP_ITEM_BEGIN, item_begin);
+        w.push(DAPP_ITEM_COUNT, item_count - item_begin);
+    }
+
+    for (auto& g : groups) {
+        w.push(GROUPS, g);
+    }
+
+    //lay out sections after header
+    file_header hdr = {};
+    std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+    hdr.format_version = FORMAT_VERSION;
+    hdr.watermark = cat.watermark;
+    hdr.dapp_count = static_cast<uint32_t>(rows.size());
+    hdr.item_count = item_count;
+    hdr.group_count = static_cast<uint32_t>(groups.size());
+
+    uint64_t offset = align8(sizeof(file_header));
+    for (uint32_t sec = 0; sec < SECTION_COUNT; sec++) {
+        hdr.section_offsets[sec] = offset;
+        hdr.section_sizes[sec] = w.sections[sec].size();
+        offset = align8(offset + w.sections[sec].size());
+    }
+    hdr.file_size = offset;
+
+    //write temp file, then rename over path
+    string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        check(out.good(), "snapshot: cannot open " + tmp_path);
+
+        string padding(8, '\0');
+        out.write(reinterpret_cast<const char*>(&hdr), sizeof(hdr));
+        out.write(padding.data(), align8(sizeof(hdr)) - sizeof(hdr));
+
+        for (uint32_t sec = 0; sec < SECTION_COUNT; sec++) {
+            const string& data = w.sections[sec];
+            out.write(data.data(), data.size());
+            out.write(padding.data(), align8(data.size()) - data.size());
+        }
+
+        out.flush();
+        check(out.good(), "snapshot: write failed for " + tmp_path);
+    }
+    check(std::rename(tmp_path.c_str(), path.c_str()) == 0, "snapshot: cannot replace " + path);
+
+}
+
+snapshot_view::snapshot_view(const string& path) {
+
+    //open and map file
+    int fd = ::open(path.c_str(), O_RDONLY);
+    check(fd >= 0, "snapshot: cannot open " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(file_header))) {
+        ::close(fd);
+        check(false, "snapshot: file too small " + path);
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    check(mapped != MAP_FAILED, "snapshot: cannot map " + path);
+
+    base = static_cast<const char*>(mapped);
+    hdr = reinterpret_cast<const file_header*>(base);
+
+    //validate header and section bounds
+    auto fail = [&](const string& message) {
+        ::munmap(const_cast<char*>(base), size);
+        base = nullptr;
+        check(false, message);
+    };
+
+    if (std::memcmp(hdr->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        fail("snapshot: bad magic");
+    }
+    if (hdr->format_version != FORMAT_VERSION) {
+        fail("snapshot: unsupported format version");
+    }
+    if (hdr->file_size != size) {
+        fail("snapshot: truncated file");
+    }
+
+    const uint64_t dapp_bytes[] = {8, 8, 8, 8, 4, 4, 4, 4, 8, 8, 8, 8, 8, 8, 8};
+    for (uint32_t sec = 0; sec < SECTION_COUNT; sec++) {
+        uint64_t expected = sec <= DAPP_VERSION ? dapp_bytes[sec] * hdr->dapp_count :
+            sec == GROUPS ? sizeof(group) * uint64_t(hdr->group_count) :
+            sec == ITEM_DAPP || sec == ITEM_STOCK ? 4 * uint64_t(hdr->item_count) :
+            sec == STRINGS ? hdr->section_sizes[STRINGS] :
+            8 * uint64_t(hdr->item_count);
+
+        if (hdr->section_sizes[sec] != expected || hdr->section_offsets[sec] % 8 != 0 ||
+            hdr->section_offsets[sec] > size || hdr->section_sizes[sec] > size - hdr->section_offsets[sec]) {
+            fail("snapshot: invalid section bounds");
+        }
+    }
+
+}
+
+snapshot_view::~snapshot_view() {
+    if (base != nullptr) {
+        ::munmap(const_cast<char*>(base), size);
+    }
+}
+
+string_view snapshot_view::str(str_ref ref) const {
+    check(uint64_t(ref.offset) + ref.length <= hdr->section_sizes[STRINGS], "snapshot: string out of range");
+    return string_view(base + hdr->section_offsets[STRINGS] + ref.offset, ref.length);
+}
+
+group snapshot_view::find_group(uint64_t category, uint64_t status) const {
+
+    //groups are sorted by category, status
+    const group* groups = column<group>(GROUPS);
+    const group* end = groups + hdr->group_count;
+    const group* g = std::lower_bound(groups, end, std::make_pair(category, status),
+        [](const group& lhs, const std::pair<uint64_t, uint64_t>& key) {
+            return std::make_pair(lhs.category, lhs.status) < key;
+        });
+
+    if (g == end || g->category != category || g->status != status) {
+        return group{category, status, 0, 0};
+    }
+
+    return *g;
+
+}
+
+catalog snapshot_view::to_catalog() const {
+
+    //initialize
+    catalog cat;
+    cat.watermark = hdr->watermark;
+
+    for (uint32_t index = 0; index < hdr->dapp_count; index++) {
+        dapp_row d;
+        d.dapp_account = column<uint64_t>(DAPP_ACCOUNT)[index];
+        d.manager = column<uint64_t>(DAPP_MANAGER)[index];
+        d.category = column<uint64_t>(DAPP_CATEGORY)[index];
+        d.status = column<uint64_t>(DAPP_STATUS)[index];
+        d.last_updated = column<uint32_t>(DAPP_LAST_UPDATED)[index];
+        d.platforms = column<uint32_t>(DAPP_PLATFORMS)[index];
+        d.icon_small = string(str(column<str_ref>(DAPP_ICON_SMALL)[index]));
+        d.icon_large = string(str(column<str_ref>(DAPP_ICON_LARGE)[index]));
+        d.title = string(str(column<str_ref>(DAPP_TITLE)[index]));
+        d.subtitle = string(str(column<str_ref>(DAPP_SUBTITLE)[index]));
+        d.description = string(str(column<str_ref>(DAPP_DESCRIPTION)[index]));
+        d.website = string(str(column<str_ref>(DAPP_WEBSITE)[index]));
+        d.version = string(str(column<str_ref>(DAPP_VERSION)[index]));
+
+        uint32_t item_begin = column<uint32_t>(DAPP_ITEM_BEGIN)[index];
+        uint32_t item_count = column<uint32_t>(DAPP_ITEM_COUNT)[index];
+        check(uint64_t(item_begin) + item_count <= hdr->item_count, "snapshot: item range out of bounds");
+
+        if (item_count > 0) {
+            vector<item_row>& items = cat.items[d.dapp_account];
+            for (uint32_t n = item_begin; n < item_begin + item_count; n++) {
+                item_row i;
+                i.item_name = column<uint64_t>(ITEM_NAME)[n];
+                i.price_amount = column<int64_t>(ITEM_PRICE_AMOUNT)[n];
+                i.price_symbol = column<uint64_t>(ITEM_PRICE_SYMBOL)[n];
+                i.price_contract = column<uint64_t>(ITEM_PRICE_CONTRACT)[n];
+                i.stock = column<uint32_t>(ITEM_STOCK)[n];
+                i.title = string(str(column<str_ref>(ITEM_TITLE)[n]));
+                i.subtitle = string(str(column<str_ref>(ITEM_SUBTITLE)[n]));
+                items.push_back(std::move(i));
+            }
+        }
+
+        cat.dapps[d.dapp_account] = std::move(d);
+    }
+
+    return cat;
+
+}
+
+}
+
+//======================== command line ========================
+
+namespace {
+
+    int usage() {
+        std::cerr << "usage:\n"
+            << "  dirsnap build <dump.json> <out.dsnap>\n"
+            << "  dirsnap apply <snapshot.dsnap> <delta.json>\n"
+            << "  dirsnap info <snapshot.dsnap>\n"
+            << "  dirsnap dump <snapshot.dsnap>\n";
+        return 1;
+    }
+
+    //formats an eosio asset, e.g. "1.5000 TLOS"
+    std::string format_asset(int64_t amount, uint64_t symbol_raw) {
+        uint8_t precision = symbol_raw & 0xff;
+        std::string code;
+        for (uint64_t raw = symbol_raw >> 8; raw > 0; raw >>= 8) {
+            code += static_cast<char>(raw & 0xff);
+        }
+
+        uint64_t magnitude = amount < 0 ? -static_cast<uint64_t>(amount) : static_cast<uint64_t>(amount);
+        std::string digits = std::to_string(magnitude);
+        if (precision > 0) {
+            if (digits.size() <= precision) {
+                digits.insert(0, precision + 1 - digits.size(), '0');
+            }
+            digits.insert(digits.size() - precision, ".");
+        }
+
+        return (amount < 0 ? "-" : "") + digits + " " + code;
+    }
+
+    //formats a platform bitmask as a comma separated list
+    std::string format_platforms(uint32_t platforms) {
+        std::string out;
+        for (uint32_t bit = 0; bit < std::size(dirsnap::PLATFORMS); bit++) {
+            if (platforms & (1u << bit)) {
+                out += (out.empty() ? "" : ",") + std::string(dirsnap::PLATFORMS[bit]);
+            }
+        }
+        return out;
+    }
+
+    void print_info(const dirsnap::snapshot_view& view) {
+        const dirsnap::file_header& hdr = view.header();
+        std::cout << "dapps: " << hdr.dapp_count << "\n"
+            << "items: " << hdr.item_count << "\n"
+            << "watermark: " << hdr.watermark << "\n";
+
+        const dirsnap::group* groups = view.column<dirsnap::group>(dirsnap::GROUPS);
+        for (uint32_t g = 0; g < hdr.group_count; g++) {
+            std::cout << dirsnap::name_to_string(groups[g].category) << "/"
+                << dirsnap::name_to_string(groups[g].status) << ": "
+                << groups[g].begin << " +" << groups[g].count << "\n";
+        }
+    }
+
+    //prints every row straight from the mapped columns
+    void print_rows(const dirsnap::snapshot_view& view) {
+        using namespace dirsnap;
+        const file_header& hdr = view.header();
+
+        for (uint32_t d = 0; d < hdr.dapp_count; d++) {
+            std::cout << "dapp " << d << " " << name_to_string(view.column<uint64_t>(DAPP_ACCOUNT)[d])
+                << " manager=" << name_to_string(view.column<uint64_t>(DAPP_MANAGER)[d])
+                << " category=" << name_to_string(view.column<uint64_t>(DAPP_CATEGORY)[d])
+                << " status=" << name_to_string(view.column<uint64_t>(DAPP_STATUS)[d])
+                << " last_updated=" << view.column<uint32_t>(DAPP_LAST_UPDATED)[d]
+                << " platforms=" << format_platforms(view.column<uint32_t>(DAPP_PLATFORMS)[d])
+                << " items=" << view.column<uint32_t>(DAPP_ITEM_BEGIN)[d]
+                << " +" << view.column<uint32_t>(DAPP_ITEM_COUNT)[d] << "\n"
+                << "  title=\"" << view.str(view.column<str_ref>(DAPP_TITLE)[d]) << "\""
+                << " subtitle=\"" << view.str(view.column<str_ref>(DAPP_SUBTITLE)[d]) << "\""
+                << " version=\"" << view.str(view.column<str_ref>(DAPP_VERSION)[d]) << "\"\n"
+                << "  description=\"" << view.str(view.column<str_ref>(DAPP_DESCRIPTION)[d]) << "\""
+                << " website=\"" << view.str(view.column<str_ref>(DAPP_WEBSITE)[d]) << "\""
+                << " icon_small=\"" << view.str(view.column<str_ref>(DAPP_ICON_SMALL)[d]) << "\""
+                << " icon_large=\"" << view.str(view.column<str_ref>(DAPP_ICON_LARGE)[d]) << "\"\n";
+        }
+
+        for (uint32_t i = 0; i < hdr.item_count; i++) {
+            std::cout << "item " << i << " dapp=" << view.column<uint32_t>(ITEM_DAPP)[i]
+                << " " << name_to_string(view.column<uint64_t>(ITEM_NAME)[i])
+                << " price=" << format_asset(view.column<int64_t>(ITEM_PRICE_AMOUNT)[i], view.column<uint64_t>(ITEM_PRICE_SYMBOL)[i])
+                << "@" << name_to_string(view.column<uint64_t>(ITEM_PRICE_CONTRACT)[i])
+                << " stock=" << view.column<uint32_t>(ITEM_STOCK)[i]
+                << " title=\"" << view.str(view.column<str_ref>(ITEM_TITLE)[i]) << "\""
+                << " subtitle=\"" << view.str(view.column<str_ref>(ITEM_SUBTITLE)[i]) << "\"\n";
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        return usage();
+    }
+
+    std::string command = argv[1];
+
+    try {
+        if (command == "build" && argc == 4) {
+            dirsnap::write_snapshot(dirsnap::read_dump(argv[2]), argv[3]);
+        } else if (command == "apply" && argc == 4) {
+            dirsnap::catalog cat = dirsnap::snapshot_view(argv[2]).to_catalog();
+            dirsnap::apply_delta(cat, dirsnap::read_dump(argv[3]));
+            dirsnap::write_snapshot(cat, argv[2]);
+        } else if (command == "info" && argc == 3) {
+            print_info(dirsnap::snapshot_view(argv[2]));
+        } else if (command == "dump" && argc == 3) {
+            print_rows(dirsnap::snapshot_view(argv[2]));
+        } else {
+            return usage();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "dirsnap: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+
+}
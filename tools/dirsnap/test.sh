@@ -0,0 +1,30 @@
+#! /bin/bash
+
+# runs dirsnap build/apply against fixtures and compares info and row dump output
+
+set -e
+
+dir=$(cd "$(dirname "$0")" && pwd)
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+echo ">>> Building dirsnap tool..."
+g++ -std=c++17 -O2 -I"$dir/include/" -o "$out/dirsnap" "$dir/src/dirsnap.cpp"
+
+echo ">>> build fixtures/dump.json"
+"$out/dirsnap" build "$dir/fixtures/dump.json" "$out/directory.dsnap"
+"$out/dirsnap" info "$out/directory.dsnap" | diff -u "$dir/fixtures/expected_build.txt" -
+"$out/dirsnap" dump "$out/directory.dsnap" | diff -u "$dir/fixtures/expected_build_dump.txt" -
+
+echo ">>> apply fixtures/delta.json"
+"$out/dirsnap" apply "$out/directory.dsnap" "$dir/fixtures/delta.json"
+"$out/dirsnap" info "$out/directory.dsnap" | diff -u "$dir/fixtures/expected_apply.txt" -
+"$out/dirsnap" dump "$out/directory.dsnap" | diff -u "$dir/fixtures/expected_apply_dump.txt" -
+
+echo ">>> reject non-snapshot input"
+if "$out/dirsnap" info "$dir/fixtures/dump.json" 2>/dev/null; then
+    echo "expected info to reject a json dump"
+    exit 1
+fi
+
+echo ">>> dirsnap tests passed"